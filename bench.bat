@@ -0,0 +1,26 @@
+@rem ----------------------------------------------------------------------
+@rem --- benchmark nth-prime on a fixed matrix of queries
+@rem --- output: the query and the line of --timings (phases, peak RSS)
+@rem ----------------------------------------------------------------------
+@for %%q in (
+"1000000"
+"10000000"
+"10000000 100000"
+) do @(
+  echo nth-prime --engine incremental %%~q
+  nth-prime --engine incremental --timings %%~q >nul
+)
+@for %%q in (
+"1000000"
+"10000000"
+"1000000000"
+"100000000000"
+"10000000 100000"
+"1000000000 1000000"
+"100000000000 1000000"
+"--count 1000000000000 1001000000000"
+"--count 1000000000000"
+) do @(
+  echo nth-prime %%~q
+  nth-prime --timings %%~q >nul
+)
@@ -0,0 +1,81 @@
+# ----------------------------------------------------------------------
+# --- benchmark the engines on a fixed matrix of queries
+# --- output: one CSV line per engine and query (best of BENCH_RUNS runs)
+# ---   wall_s       wall time of the whole process
+# ---   primes       n, the number of primes listed or counted
+# ---   max_rss_kib  peak resident set size
+# ---   *_s          phases reported by --timings (nth-prime only)
+# --- with BENCH_BASELINE=file.csv the column vs_baseline shows the
+# --- ratio of wall_s to the same query in an earlier run
+# ----------------------------------------------------------------------
+bench_runs=${BENCH_RUNS:-3}
+bench_baseline=${BENCH_BASELINE:-}
+
+# engine|query, the engine is a program with its options;
+# the incremental ones only get the small queries
+bench_matrix="\
+nth-prime|1000000
+nth-prime|10000000
+nth-prime|1000000000
+nth-prime|100000000000
+nth-prime|10000000 100000
+nth-prime|1000000000 1000000
+nth-prime|100000000000 1000000
+nth-prime|--count 1000000000000 1001000000000
+nth-prime|--count 1000000000000
+nth-prime --engine incremental|1000000
+nth-prime --engine incremental|10000000
+nth-prime --engine incremental|10000000 100000
+nth-prime-alternative-1|1000000
+nth-prime-alternative-1|10000000
+nth-prime-alternative-1|10000000 100000"
+
+# value of a field of the --timings line (empty if there is none)
+bench_field() {
+  local value=${bench_timings##*$1=}
+  [ "$value" == "$bench_timings" ] && return
+  echo ${value%% *}
+}
+
+echo "engine,query,wall_s,primes,primes_per_s,max_rss_kib,bound_s,base_s,segments_s,output_s,vs_baseline"
+while IFS='|' read -r bench_engine bench_query; do
+  bench_program=${bench_engine%% *}
+  [ -x "./$bench_program" ] || { echo "$bench_program: not built" >&2; continue; }
+  bench_options=""
+  [ "$bench_program" == "nth-prime" ] && bench_options="--timings"
+
+  bench_best=""
+  for ((bench_run = 0; bench_run < bench_runs; bench_run++)); do
+    bench_start=$(date +%s%N)
+    bench_output=$(./$bench_engine $bench_options $bench_query 2>/tmp/bench-timings.$$ | tail -1)
+    bench_wall=$(( $(date +%s%N) - bench_start ))
+    if [ -z "$bench_best" ] || [ $bench_wall -lt $bench_best ]; then
+      bench_best=$bench_wall
+      bench_timings=$(grep '^timings:' /tmp/bench-timings.$$ || true)
+    fi
+  done
+  rm -f /tmp/bench-timings.$$
+
+  # primes: n, c for "n c", m - n + 1 for "n m", the result of --count
+  set -- $bench_query
+  if [ "$1" == "--count" ]; then
+    bench_primes=${bench_output##* }
+  elif [ $# == 2 ] && [ $1 -gt $2 ]; then
+    bench_primes=$2
+  elif [ $# == 2 ]; then
+    bench_primes=$(( $2 - $1 + 1 ))
+  else
+    bench_primes=$1
+  fi
+
+  bench_ratio=""
+  if [ -n "$bench_baseline" ] && [ -f "$bench_baseline" ]; then
+    bench_ratio=$(awk -F, -v e="$bench_engine" -v q="$bench_query" -v w="$bench_best" \
+                  '$1 == e && $2 == q && $3 > 0 { printf "%.3f", w / 1e9 / $3 }' "$bench_baseline")
+  fi
+  awk -v e="$bench_engine" -v q="$bench_query" -v w="$bench_best" -v n="$bench_primes" \
+      -v rss="$(bench_field max_rss_kib)" -v b1="$(bench_field bound)" -v b2="$(bench_field base)" \
+      -v b3="$(bench_field segments)" -v b4="$(bench_field output)" -v r="$bench_ratio" \
+      'BEGIN { s = w / 1e9; printf "%s,%s,%.6f,%s,%.0f,%s,%s,%s,%s,%s,%s\n",
+                                    e, q, s, n, n / s, rss, b1, b2, b3, b4, r }'
+done <<< "$bench_matrix"
@@ -10,7 +10,15 @@
   Wenn zwei Argumente (n,c) angegeben werden und n > c ist, dann werden die c
   Primzahlen vor der n-ten (einschlielich) ausgegeben.
 
-  Aufruf: nth-prime Nummer (> 0) [Nummer (> 0)] 
+  Die Primzahlen kommen aus einem Generator ohne obere Grenze, dessen Sieb
+  mit der Wurzel der aktuellen Zahl wchst (siehe next_prime).
+
+  Mit der Option -r D wird der Zustand (Nummer und Wert der letzten
+  ausgegebenen Primzahl) in der Datei D gespeichert. Liegt er beim nchsten
+  Aufruf vor der n_start-ten Primzahl, wird von dort aus weitergesiebt, so
+  dass z.B. "die nchsten K Primzahlen" nicht jedes Mal bei 3 beginnen.
+
+  Aufruf: nth-prime [-r Datei] Nummer (> 0) [Nummer (> 0)]
 
   Compile: cc -O2 -o nth-prime nth-prime.c -lm
      oder: cl /nologo /O2 /Fe: nth-prime.exe nth-prime.c
@@ -30,22 +38,44 @@ typedef unsigned int           uint32;
 typedef struct {
   uint64 n_start;
   uint64 n;
+  const char* state_file;  /* NULL: keine */
 } Parameters;
 
 typedef struct {
+  uint64 index;          /* Nummer der letzten ausgegebenen Primzahl */
+  uint64 prime;
+} State;
+
+/* Generator fr die ungeraden Primzahlen > number */
+typedef struct Generator {
+  uint64  number;        /* zuletzt geprfte ungerade Zahl */
+  uint64  i;             /* deren Platz in data */
   uint64  width_mask;
-  uint32* data;
-} Sieve;
+  uint32* data;          /* Ring mit je einem Primfaktor fr knftige Vielfache */
+  uint32  next_base;     /* nchste Primzahl, die noch nicht im Ring steht, */
+  uint64  next_square;   /* und deren Quadrat (0: jenseits von 2^64) */
+  struct Generator* base;  /* liefert die Primzahlen nach next_base (NULL: noch keiner) */
+} Generator;
 
 /*------------------------------------------------------------------------------
  Prototypen
 ------------------------------------------------------------------------------*/
 Parameters get_parameters(int argc, char** argv);
 Parameters reinterprete_parameters(Parameters p);
-void print_primes(uint64 n);
-void print_prime(uint64 prime_number);
-Sieve build_sieve(uint32 sqrt_n);
-void sieve_primes(uint64 n, uint32 sqrt_p, uint64 sieve_width_mask, uint32* sieve_data);
+void print_primes(uint64 n, const char* state_file);
+void print_prime(uint64 index, uint64 prime_number);
+int read_state(const char* path, State* state);
+int is_plausible_state(State state);
+uint64 state_checksum(State state);
+int is_prime(uint64 x);
+void write_state(const char* path, State state);
+Generator* create_generator(uint64 start);
+void destroy_generator(Generator* generator);
+uint64 next_prime(Generator* generator);
+void add_base_prime(Generator* generator, uint64 multiple);
+void move_factor(Generator* generator, uint64 j, uint32 factor);
+void grow_generator(Generator* generator, uint64 width);
+uint32* build_sieve(uint64 width);
 uint64 inverse_pi(uint64 n);
 uint64 atoul(const char* s);
 uint32 integer_square_root(uint64 x);
@@ -61,13 +91,18 @@ uint64 n_start;
 ------------------------------------------------------------------------------*/
 #define odd(n) ((n - 1) | 1)
 
+/*------------------------------------------------------------------------------
+  Konstanten
+------------------------------------------------------------------------------*/
+#define MIN_SIEVE_WIDTH 64   /* Anfangsgre des Rings */
+
 /*------------------------------------------------------------------------------
   Beginn der Verarbeitung 
 ------------------------------------------------------------------------------*/
 int main(int argc, char* argv[]) {
   Parameters p = get_parameters(argc, argv);
   n_start = p.n_start;
-  print_primes(p.n);
+  print_primes(p.n, p.state_file);
   return 0;
 }
 
@@ -76,12 +111,19 @@ int main(int argc, char* argv[]) {
 ------------------------------------------------------------------------------*/
 Parameters get_parameters(int argc, char** argv) {
   Parameters p;
+  p.state_file = NULL;
 
+  if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+    p.state_file = argv[2];
+    argc -= 2;
+    argv += 2;
+  }
   if (   argc != 2 && argc != 3
       || argc == 2 && (   (p.n_start = p.n = atoul(argv[1])) < 1)
       || argc == 3 && (   (p.n_start =       atoul(argv[1])) < 1
                        || (            p.n = atoul(argv[2])) < 1)) {
-     fprintf(stderr, "usage: nth-prime Number (in (0,2^64)) [Number/Count (in (0,2^64))]\n");
+     fprintf(stderr, "usage: nth-prime [-r State-File] Number (in (0,2^64))"
+                     " [Number/Count (in (0,2^64))]\n");
      exit(1);
   }
   p = reinterprete_parameters(p);
@@ -103,19 +145,38 @@ Parameters reinterprete_parameters(Parameters p) {
 }
 
 /*------------------------------------------------------------------------------
-  Gibt alle Primzahlen bis zur n-ten aus.
+  Gibt alle Primzahlen bis zur n-ten aus (ab der n_start-ten).
+
+  Mit einer Zustandsdatei wird nach deren letzter Primzahl begonnen, wenn
+  diese vor der n_start-ten liegt, und am Ende der neue Zustand gespeichert.
 ------------------------------------------------------------------------------*/
-void print_primes(uint64 n) {
-  uint64 p = inverse_pi(n);
-  if (p == 0) {
+void print_primes(uint64 n, const char* state_file) {
+  if (inverse_pi(n) == 0) {
     fprintf(stderr, "value %llu too large\n", n);
     exit(2);
   }
 
-  print_prime(2);
-  uint32 sqrt_p = odd(integer_square_root(p));
-  Sieve sieve = build_sieve(sqrt_p);
-  sieve_primes(n, sqrt_p, sieve.width_mask, sieve.data);
+  State state;
+  if (state_file == NULL || read_state(state_file, &state) == 0 || state.index >= n_start) {
+    state.index = 1;
+    state.prime = 2;
+    print_prime(state.index, state.prime);
+  }
+
+  Generator* generator = create_generator(state.prime + 1);
+  while (state.index < n) {
+    if ((state.prime = next_prime(generator)) == 0) {
+      fprintf(stderr, "value %llu too large\n", n);
+      exit(2);
+    }
+    state.index += 1;
+    print_prime(state.index, state.prime);
+  }
+  destroy_generator(generator);
+
+  if (state_file != NULL) {
+    write_state(state_file, state);
+  }
 }
 
 /*------------------------------------------------------------------------------
@@ -123,72 +184,290 @@ void print_primes(uint64 n) {
 
   Primzahlen < der n_start-ten werden nicht ausgegeben.
 ------------------------------------------------------------------------------*/
-void print_prime(uint64 prime_number) {
-  static uint64 primes_count = 0;
-  primes_count += 1;
-  if (primes_count >= n_start) {
-    printf("%llu. prime = %llu\n", primes_count, prime_number);
+void print_prime(uint64 index, uint64 prime_number) {
+  if (index >= n_start) {
+    printf("%llu. prime = %llu\n", index, prime_number);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Liest den Zustand "Nummer Primzahl Prfsumme" aus der Datei path.
+  Zurckgegeben wird 0, wenn es die Datei (noch) nicht gibt. Ein Zustand
+  ohne passende Prfsumme (state_checksum) oder einer, der nicht stimmen
+  kann (is_plausible_state), ist ein Fehler.
+------------------------------------------------------------------------------*/
+int read_state(const char* path, State* state) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    if (errno == ENOENT) {
+      return 0;
+    }
+    perror(path);
+    exit(4);
+  }
+  uint64 checksum;
+  if (   fscanf(file, "%llu %llu %llx", &state->index, &state->prime, &checksum) != 3
+      || checksum != state_checksum(*state)
+      || is_plausible_state(*state) == 0) {
+    fprintf(stderr, "%s: invalid state\n", path);
+    exit(4);
+  }
+  fclose(file);
+  return 1;
+}
+
+/*------------------------------------------------------------------------------
+  Prft, ob prime die index-te Primzahl sein kann: sie muss eine Primzahl
+  sein und zwischen den Schranken fr die index-te liegen. Mit
+
+       x/ln(x) < pi(x) < 1,25506 * x/ln(x)   (fr x > 10 bzw. x > 1)
+
+  ist sie hchstens inverse_pi(index), und index < 1,25506 * prime/ln(prime).
+  Die Probedivision kostet dann hchstens so viel wie das Sieben bis prime.
+------------------------------------------------------------------------------*/
+int is_plausible_state(State state) {
+  if (state.index <= 2) {
+    return state.prime == state.index + 1;
+  }
+  uint64 upper = inverse_pi(state.index);
+  return    upper != 0 && state.prime <= upper
+         && state.index < 1.25506 * state.prime / log((double) state.prime)
+         && is_prime(state.prime);
+}
+
+/*------------------------------------------------------------------------------
+  Prfsumme ber Nummer und Primzahl (Mischfunktion von splitmix64).
+
+  Die Schranken in is_plausible_state lassen fr eine Primzahl viele
+  Nummern zu, z.B. "998 7919" statt "1000 7919". Eine falsche Nummer wrde
+  dann unbemerkt weitergezhlt; mit der Prfsumme wird nur ein Zustand
+  angenommen, den write_state so geschrieben hat.
+------------------------------------------------------------------------------*/
+uint64 state_checksum(State state) {
+  uint64 h = state.index * 0x9e3779b97f4a7c15ULL ^ state.prime;
+  for (int i = 0; i < 2; i++) {
+    h = (h ^ h >> 30) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ h >> 27) * 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+  }
+  return h;
+}
+
+/*------------------------------------------------------------------------------
+  Prft mit Probedivision, ob x eine Primzahl ist.
+------------------------------------------------------------------------------*/
+int is_prime(uint64 x) {
+  if (x < 4) {
+    return x >= 2;
+  }
+  if (x % 2 == 0) {
+    return 0;
+  }
+  for (uint64 d = 3; d <= x / d; d += 2) {
+    if (x % d == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------------
+  Speichert den Zustand mit seiner Prfsumme in der Datei path.
+
+  Geschrieben wird erst in path.tmp, die dann path ersetzt: so bleibt bei
+  einem Absturz der alte Zustand erhalten und nicht eine halbe Datei, die
+  read_state ablehnt.
+------------------------------------------------------------------------------*/
+void write_state(const char* path, State state) {
+  char* temp_path;
+  if ((temp_path = malloc(strlen(path) + 5)) == NULL) {
+    perror("memory error");
+    exit(3);
+  }
+  strcpy(temp_path, path);
+  strcat(temp_path, ".tmp");
+
+  FILE* file = fopen(temp_path, "w");
+  if (   file == NULL
+      || fprintf(file, "%llu %llu %016llx\n", state.index, state.prime, state_checksum(state)) < 0
+      || fclose(file) != 0) {
+    perror(temp_path);
+    exit(4);
+  }
+#ifdef _WIN32
+  remove(path);   /* rename ersetzt unter Windows keine vorhandene Datei */
+#endif
+  if (rename(temp_path, path) != 0) {
+    perror(path);
+    exit(4);
   }
+  free(temp_path);
 }
 
 /*------------------------------------------------------------------------------
-  Baut ein Sieb auf, das ausreichend gro und mit Nullen initialisiert ist.
+  Legt einen Generator an, der zuerst die kleinste ungerade Primzahl >= start
+  liefert (start >= 3).
 
-  Speicher wird in einer Grenordnung von 2 mal der Wurzel von n bentigt.
+  Die Primzahlen p mit p^2 < start kommen dabei gleich mit ihrem ersten
+  ungeraden Vielfachen >= start in den Ring.
 ------------------------------------------------------------------------------*/
-Sieve build_sieve(uint32 sqrt_p) {
-  Sieve sieve;
-
-  uint64 sieve_width = round_up_to_next_power_of_2((uint64) sqrt_p * 2);
-  uint64 sieve_size = sieve_width * sizeof(sieve.data[0]);
-  sieve.width_mask = sieve_width - 1;
-  
-  if (   sieve_size > (size_t) sieve_size && (errno = ENOMEM)
-      || (sieve.data = malloc((size_t) sieve_size)) == NULL) {
+Generator* create_generator(uint64 start) {
+  Generator* generator;
+  if ((generator = malloc(sizeof(*generator))) == NULL) {
     perror("memory error");
     exit(3);
   }
-  memset(sieve.data, 0, (size_t) sieve_size);
-  return sieve;
+  generator->number = (start | 1) - 2;
+  generator->i = 0;
+  generator->width_mask = MIN_SIEVE_WIDTH - 1;
+  generator->data = build_sieve(MIN_SIEVE_WIDTH);
+  generator->next_base = 3;
+  generator->next_square = 9;
+  generator->base = NULL;
+
+  while (generator->next_square != 0 && generator->next_square <= generator->number) {
+    uint64 p = generator->next_base;
+    uint64 multiple = (generator->number + 2 + p - 1) / p * p;
+    add_base_prime(generator, multiple % 2 == 0 ? multiple + p : multiple);
+  }
+  return generator;
 }
 
 /*------------------------------------------------------------------------------
-  Berechnet mit dem Algorithmus des Eratosthenes alle Primzahlen ab 3 bis zur
-  n-ten und gibt sie aus.
+  Gibt einen Generator mit allen, die seine Primfaktoren liefern, frei.
 ------------------------------------------------------------------------------*/
-void sieve_primes(uint64 n, uint32 sqrt_p, uint64 sieve_width_mask, uint32* sieve_data) {
-  uint64 count_primes = 1;
-  uint64 i = 0;
-
-  for (uint64 number = 3; count_primes < n; number += 2) {
-    i = (i + 1) & sieve_width_mask;
-    uint32 factor;
-    if (sieve_data[i] == 0) {
-      count_primes += 1;
-      print_prime(number);
-      if (number > sqrt_p) {
-        continue;
-      }
-      factor = (uint32) number;
-    } else {
-      factor = sieve_data[i];
-      sieve_data[i] = 0;
+void destroy_generator(Generator* generator) {
+  while (generator != NULL) {
+    Generator* base = generator->base;
+    free(generator->data);
+    free(generator);
+    generator = base;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet mit dem Algorithmus des Eratosthenes die nchste Primzahl
+  (0: keine mehr < 2^64).
+
+  Der Ring data hat einen Platz je ungerade Zahl ab number. In einem Platz
+  steht ein Primfaktor p, wenn die Zahl dort ein Vielfaches von p ist. Ist
+  die Zahl erreicht, wandert p um 2p weiter (ist der Platz dort belegt, bleibt
+  der grere Faktor stehen und der kleinere wandert weiter).
+
+  Eine Primzahl p kommt erst in den Ring, wenn number ihr Quadrat erreicht.
+  Die Primzahlen dafr liefert ein zweiter Generator (base), der nur bis zur
+  Wurzel von number laufen muss und seinerseits erst bei Bedarf angelegt
+  wird. Der Ring wchst so mit der Wurzel von number, nicht mit der Anzahl
+  der Primzahlen.
+------------------------------------------------------------------------------*/
+uint64 next_prime(Generator* generator) {
+  uint64* number = &generator->number;
+  uint64 i = generator->i;
+  uint64 width_mask = generator->width_mask;
+  uint32* data = generator->data;
+
+  do {
+    if (*number >= ~0ULL - 2) {
+      generator->i = i;
+      return 0;
+    }
+    *number += 2;
+    i = (i + 1) & width_mask;
+
+    if (*number == generator->next_square) {
+      generator->i = i;
+      add_base_prime(generator, *number + 2ULL * generator->next_base);
+      width_mask = generator->width_mask;
+      data = generator->data;
+      continue;
+    }
+    if (data[i] == 0) {
+      break;
     }
+    uint32 factor = data[i];
+    data[i] = 0;
+    move_factor(generator, i, factor);
+  } while (1);
 
-    uint64 j = i;
-    do {
-      j = (j + factor) & sieve_width_mask;
-      if (sieve_data[j] == 0) {
-        break;
-      }
-      if (sieve_data[j] < factor) {
-        uint32 smaller_factor = sieve_data[j];
-        sieve_data[j] = factor;
-        factor = smaller_factor;
-      }
-    } while (1);
-    sieve_data[j] = factor;
+  generator->i = i;
+  return *number;
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt next_base mit dem ungeraden Vielfachen multiple (> number) in den
+  Ring auf und holt die nchste Primzahl vom Generator base.
+
+  Der Ring wird vorher so weit vergrert, dass er mindestens 2 * next_base
+  Pltze hat; so weit kann ein Faktor hchstens vorauslaufen.
+------------------------------------------------------------------------------*/
+void add_base_prime(Generator* generator, uint64 multiple) {
+  uint32 p = generator->next_base;
+  if (generator->width_mask < 2ULL * p) {
+    grow_generator(generator, round_up_to_next_power_of_2(2ULL * p + 1));
+  }
+  move_factor(generator, generator->i + (multiple - generator->number) / 2 - p, p);
+
+  if (generator->base == NULL) {
+    generator->base = create_generator(p + 2);
+  }
+  uint64 q = next_prime(generator->base);
+  generator->next_base = (uint32) q;
+  generator->next_square = q == 0 || q > 0xffffffffULL ? 0 : q * q;
+}
+
+/*------------------------------------------------------------------------------
+  Setzt factor vom Platz j aus auf den nchsten freien Platz j + k * factor
+  (k >= 1).
+  Ist ein Platz mit einem kleineren Faktor belegt, werden die beiden
+  getauscht.
+------------------------------------------------------------------------------*/
+void move_factor(Generator* generator, uint64 j, uint32 factor) {
+  uint64 width_mask = generator->width_mask;
+  uint32* data = generator->data;
+  do {
+    j = (j + factor) & width_mask;
+    if (data[j] == 0) {
+      break;
+    }
+    if (data[j] < factor) {
+      uint32 smaller_factor = data[j];
+      data[j] = factor;
+      factor = smaller_factor;
+    }
+  } while (1);
+  data[j] = factor;
+}
+
+/*------------------------------------------------------------------------------
+  Vergrert den Ring auf width Pltze (Potenz von 2). Jeder Faktor behlt
+  seinen Abstand zu number.
+------------------------------------------------------------------------------*/
+void grow_generator(Generator* generator, uint64 width) {
+  uint32* data = build_sieve(width);
+  uint64 width_mask = width - 1;
+  for (uint64 d = 0; d <= generator->width_mask; d++) {
+    uint64 j = (generator->i + d) & generator->width_mask;
+    data[(generator->i + d) & width_mask] = generator->data[j];
+  }
+  free(generator->data);
+  generator->data = data;
+  generator->width_mask = width_mask;
+}
+
+/*------------------------------------------------------------------------------
+  Baut einen Ring mit width Pltzen auf, der mit Nullen initialisiert ist.
+------------------------------------------------------------------------------*/
+uint32* build_sieve(uint64 width) {
+  uint32* data;
+  uint64 size = width * sizeof(data[0]);
+
+  if (   size > (size_t) size && (errno = ENOMEM)
+      || (data = malloc((size_t) size)) == NULL) {
+    perror("memory error");
+    exit(3);
   }
+  memset(data, 0, (size_t) size);
+  return data;
 }
 
 /*==============================================================================
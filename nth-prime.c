@@ -10,15 +10,107 @@
   Wenn zwei Argumente (n,c) angegeben werden und n > c ist, dann werden die c
   Primzahlen vor der n-ten (einschlielich) ausgegeben.
 
-  Aufruf: nth-prime Nummer (> 0) [Nummer (> 0)] 
+  Mit der Option -t T werden die Blcke des Siebs von T Threads parallel
+  bearbeitet.
+  Mit der Option -s S wird die Gre eines Segments auf S KiB festgelegt,
+  sonst auf die Gre des L1-Daten-Caches.
+  Mit der Option --max-memory M braucht eine Abfrage ungefhr hchstens M MiB
+  Speicher (siehe nthprime_set_max_memory); bei Abfragen nahe 2^64 ist das
+  etwas langsamer, pi(x) wird darber hinaus durch Sieben ersetzt.
+  Mit der Option -c D werden Checkpoints (x, pi(x)) in der Datei D
+  gespeichert und wiederverwendet, so dass wiederholte und benachbarte
+  Abfragen nur noch ein kurzes Stck sieben mssen.
+  Mit der Option -f F wird das Ausgabeformat gewhlt:
+    text   "n. prime = p" je Zeile (Standard)
+    bare   nur p je Zeile
+    delta  binr, Abstand zur vorigen Primzahl als Varint (LEB128)
+    raw    binr, p als 64-Bit-Zahl (little endian)
 
-  Compile: cc -O2 -o nth-prime nth-prime.c -lm
-     oder: cl /nologo /O2 /Fe: nth-prime.exe nth-prime.c
+  Mit der Option --engine E wird das Verfahren gewhlt, mit dem die
+  Primzahlen gemeldet werden: segmented (segmentiertes Sieb), incremental
+  (inkrementelles Sieb aus nth-prime-alternative-1) oder auto (Standard: je
+  Abfrage das schnellere). --engines gibt alle Namen aus. Stapel (-b) und
+  Werte (--count usw.) werden immer segmentiert gesiebt.
+
+  Mit der Option -p S wird alle S Sekunden der Fortschritt auf stderr
+  ausgegeben: Phase (pi oder sieve), erledigter Anteil, z, Nummer der
+  letzten gefundenen Primzahl, Segmente, Zahlen je Sekunde, geschtzte
+  Restzeit der Phase, gestrichene Vielfache je Segment und die Zeit fr das
+  Sieben und das Auswerten der Segmente.
+  Mit der Option --timings werden am Ende die Laufzeiten der Phasen und der
+  grte Speicherbedarf (Peak RSS) auf stderr ausgegeben, als eine Zeile
+  "timings: total=... bound=... base=... segments=... output=... max_rss_kib=...".
+
+  Mit der Option -b D werden viele Abfragen auf einmal beantwortet: jede
+  Zeile der Datei D (-: Standardeingabe) enthlt eine oder zwei Nummern wie
+  auf der Kommandozeile. Alle Abfragen werden in einem Durchgang durch das
+  Sieb beantwortet (nthprime_primes_batch), die Ausgabe folgt aber der
+  Reihenfolge der Zeilen. Leere Zeilen und Zeilen mit # werden bersprungen.
+
+  Mit den Optionen --count, --sum und --gaps-histogram werden statt der
+  Nummern Werte angegeben, und es wird nur die Anzahl, die Summe oder die
+  Hufigkeit der Abstnde aller Primzahlen von x0 bis x (bzw. bis x)
+  ausgegeben.
+  Ebenso werden mit --gaps G alle Abstnde >= G zwischen aufeinander
+  folgenden Primzahlen ("p q gap") und mit --record-gaps die Rekorde
+  darunter ausgegeben, mit --twins, --triplets (beide Formen) und
+  --quadruplets die Primzahl-Tupel mit allen ihren Primzahlen je Zeile.
+
+  Mit der Option --shard wird fr [x0, x] (bzw. [1, x]) ein Teilergebnis
+  "shard x0 x Anzahl erste letzte" ausgegeben, unabhngig von allen
+  anderen Bereichen. --merge D... (als letzte Option) liest solche Zeilen
+  aus den Dateien D (-: Standardeingabe), die lckenlos aneinander grenzen
+  mssen, und gibt je Bereich "range x0 x n0 n1" mit den absoluten Nummern
+  seiner Primzahlen, dazwischen "gap p q Abstand" an den Grenzen und am
+  Ende die Gesamtzahl aus. So lsst sich ein groer Bereich auf mehrere
+  Prozesse oder Rechner verteilen.
+
+  Mit den Optionen --pi, --next, --prev und --is-prime wird fr einen Wert
+  x nur pi(x), die nchste Primzahl > x, die vorige < x (jeweils 0: keine)
+  oder 1 bzw. 0 fr "x ist (k)eine Primzahl" ausgegeben. Die letzten drei
+  brauchen nur einen Miller-Rabin-Test und ein kurzes Sieb um x.
+
+  Aufruf: nth-prime [-t Threads] [-s KiB] [--max-memory MiB] [-c Datei] [-f Format]
+                    [-p Sekunden] [--engine Verfahren] [--timings]
+                    Nummer (> 0) [Nummer (> 0)]
+          nth-prime [-t Threads] [-s KiB] [--max-memory MiB] [-c Datei] [-f Format]
+                    [-p Sekunden] [--timings] -b Datei
+          nth-prime [-t Threads] [-s KiB] [--max-memory MiB] [-c Datei] [-p Sekunden]
+                    [--timings] --count|--sum|--gaps-histogram [Wert (> 0)] Wert (> 0)
+          nth-prime [-t Threads] [-s KiB] [--max-memory MiB] [-p Sekunden] [--timings]
+                    --gaps Abstand|--record-gaps|--twins|--triplets|--quadruplets
+                    [Wert (> 0)] Wert (> 0)
+          nth-prime [-t Threads] [-s KiB] [--max-memory MiB] [-c Datei] [--timings]
+                    --pi|--next|--prev|--is-prime Wert (> 0)
+          nth-prime [-t Threads] [-s KiB] [--max-memory MiB] [-c Datei] [-p Sekunden]
+                    [--timings] --shard [Wert (> 0)] Wert (> 0)
+          nth-prime [-c Datei] --merge Datei [Datei ...]
+          nth-prime --engines
+
+  Die Berechnung selbst steckt in der Bibliothek libnthprime (nthprime.h).
+  Die Primzahlen werden in einem eigenen Thread formatiert und geschrieben,
+  so dass das Sieb nicht auf die Ausgabe wartet (siehe print_prime).
+
+  Compile: cc -O2 -o nth-prime nth-prime.c nthprime.c -lm -pthread
+     oder: cl /nologo /O2 /Fe: nth-prime.exe nth-prime.c nthprime.c
 ------------------------------------------------------------------------------*/
-#include <math.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi")
+#endif
+#else
+#include <pthread.h>
+#include <sys/resource.h>
+#endif
+#include "nthprime.h"
 
 /*------------------------------------------------------------------------------
   Datentypen
@@ -26,60 +118,397 @@
 typedef unsigned long long int uint64;
 typedef unsigned int           uint32;
 
+typedef enum {
+  FORMAT_TEXT,
+  FORMAT_BARE,
+  FORMAT_DELTA,
+  FORMAT_RAW
+} OutputFormat;
+
+typedef enum {
+  MODE_PRIMES,
+  MODE_COUNT,
+  MODE_SUM,
+  MODE_GAPS,
+  MODE_SHARD,
+  MODE_MERGE,
+  MODE_GAP_SEARCH,
+  MODE_RECORDS,
+  MODE_TWINS,
+  MODE_TRIPLETS,
+  MODE_QUADRUPLETS,
+  MODE_PI,
+  MODE_NEXT,
+  MODE_PREV,
+  MODE_IS_PRIME
+} Mode;
+
 typedef struct {
+  uint64 hi;
+  uint64 lo;
+} uint128;
+
+typedef struct {
+  Mode   mode;
   uint64 n_start;
   uint64 n;
+  uint64 x_start;
+  uint64 x;
+  uint64 min_gap;        /* MODE_GAP_SEARCH */
+  uint32 threads_count;
+  uint32 segment_bytes;  /* 0: Gre des L1-Daten-Caches */
+  uint64 max_memory;     /* Bytes, 0: keine Obergrenze */
+  OutputFormat output_format;
+  const char* checkpoint_file;  /* NULL: keine */
+  int    timings;        /* Laufzeiten ausgeben */
+  uint32 progress_interval;  /* Sekunden, 0: kein Fortschritt */
+  const char* batch_file;    /* NULL: keine, "-": Standardeingabe */
+  const char* engine;        /* NULL: auto */
+  char** merge_files;
+  uint32 merge_files_count;
 } Parameters;
 
+#ifdef _WIN32
+typedef HANDLE             Thread;
+typedef CRITICAL_SECTION   Mutex;
+typedef CONDITION_VARIABLE Condition;
+#else
+typedef pthread_t          Thread;
+typedef pthread_mutex_t    Mutex;
+typedef pthread_cond_t     Condition;
+#endif
+
+/* Primzahlen mit fortlaufenden Nummern ab index */
+typedef struct {
+  uint64  index;
+  uint64* primes;        /* OUTPUT_CHUNK_PRIMES Eintrge */
+  uint32  count;
+  int     restart;       /* beginnt eine Abfrage (-b): Differenzen wieder ab 0 */
+} Chunk;
+
+/* Ring von Chunks zwischen Sieb und Schreib-Thread */
+typedef struct {
+  OutputFormat format;
+  uint32 size;
+  uint64 previous_prime;
+  char*  buffer;         /* OUTPUT_BUFFER_SIZE Bytes, nur im Schreib-Thread */
+  Chunk* chunks;         /* OUTPUT_CHUNKS Eintrge */
+  uint32 filling;        /* Chunk, den das Sieb gerade fllt */
+  uint32 writing;        /* Chunk, den der Schreib-Thread als nchsten schreibt */
+  uint32 pending;        /* bergebene, noch nicht geschriebene Chunks */
+  int    finished;       /* es kommen keine Chunks mehr */
+  Mutex  mutex;
+  Condition changed;     /* pending oder finished hat sich gendert */
+  Thread writer;
+} Output;
+
+typedef struct {
+  uint64* n_start;
+  uint64* n;
+  uint64  count;
+  uint64  capacity;
+} Queries;
+
+typedef struct {
+  uint64* indices;       /* aufsteigend */
+  uint64* primes;
+  uint64  count;
+  uint64  capacity;
+} Answers;
+
+typedef struct {
+  NthPrimeShard* entries;
+  uint64  count;
+  uint64  capacity;
+} Shards;
+
 /*------------------------------------------------------------------------------
   Prototypen
 ------------------------------------------------------------------------------*/
 Parameters get_parameters(int argc, char** argv);
 Parameters reinterprete_parameters(Parameters p);
-void print_primes(uint64 n);
-void print_prime(uint64 prime_number);
-uint32 calc_square_roots(uint64 n, uint32* sqrts);
-uint32* build_primes(uint32 prime_factors_count_estimated);
-char* build_sieve(uint32 sqrt_n);
-uint32 calc_prime_factors(uint32 sqrts_top, uint32* sqrts, uint32* primes, char* sieve);
-void calc_remaining_primes(uint64 n, uint32 sqrt_n, uint32 primes_top, uint32* primes, char* sieve);
-uint64 inverse_pi(uint64 n);
+void usage(void);
+void print_statistics(NthPrime* context, Mode mode, uint64 a, uint64 b);
+void print_search(NthPrime* context, Parameters p);
+void print_value(NthPrime* context, Mode mode, uint64 x);
+void print_merge(NthPrime* context, char** paths, uint32 paths_count);
+void read_shards(const char* path, Shards* shards);
+int print_gap(void* data, uint64 p, uint64 q);
+int print_tuple(void* data, uint64 p, uint64 pattern);
+void print_batch(NthPrime* context, const char* path, Output* output);
+Queries read_queries(const char* path);
+void add_query(Queries* queries, uint64 n_start, uint64 n);
+int keep_answer(void* data, uint64 index, uint64 prime_number);
+uint64 find_answer(const Answers* answers, uint64 index);
+void start_output(Output* output, OutputFormat format);
+void finish_output(Output* output);
+int print_prime(void* output, uint64 index, uint64 prime_number);
+void pass_chunk(Output* output);
+void write_chunks(Output* output);
+#ifdef _WIN32
+DWORD WINAPI writer_thread(LPVOID output);
+#else
+void* writer_thread(void* output);
+#endif
+void format_chunk(Output* output, const Chunk* chunk);
+void flush_output(Output* output);
+void lock_output(Output* output);
+void unlock_output(Output* output);
+void wait_output(Output* output);
+void signal_output(Output* output);
+uint32 format_decimal(char* str, uint64 x);
+uint32 format_decimal_128(char* str, uint128 x);
 uint64 atoul(const char* str);
-uint32 integer_square_root(uint64 x);
-uint32 estimate_number_of_primes_up_to(uint32 x);
+int is_engine(const char* name);
+void print_engines(void);
+void print_timings(const NthPrimeTimings* timings);
+void print_progress(void* data, const NthPrimeProgress* progress);
+uint64 get_max_rss_kib(void);
 
 /*------------------------------------------------------------------------------
-  globale Variablen
+  Konstanten
 ------------------------------------------------------------------------------*/
-uint64 n_start;
-
-/*------------------------------------------------------------------------------
-  Macros
-------------------------------------------------------------------------------*/
-#define odd(n) ((n - 1) | 1)
+#define MAX_THREADS     NTHPRIME_MAX_THREADS
+#define MAX_SEGMENT_KIB NTHPRIME_MAX_SEGMENT_KIB
+#define MAX_MEMORY_MIB  (1 << 30)
+#define MAX_GAP         NTHPRIME_MAX_GAP
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTPUT_CHUNKS      4         /* Chunks im Ring */
+#define OUTPUT_CHUNK_PRIMES (1 << 16) /* Primzahlen je Chunk */
+#define MAX_OUTPUT_RECORD  64        /* lngste Ausgabe einer Primzahl */
 
 /*------------------------------------------------------------------------------
   Beginn der Verarbeitung
 ------------------------------------------------------------------------------*/
 int main(int argc, char* argv[]) {
   Parameters p = get_parameters(argc, argv);
-  n_start = p.n_start;
-  print_primes(p.n);
+  NthPrimeTimings timings;
+  NthPrime* context = nthprime_create();
+  nthprime_set_threads(context, p.threads_count);
+  if (p.segment_bytes != 0) {
+    nthprime_set_segment_bytes(context, p.segment_bytes);
+  }
+  nthprime_set_max_memory(context, p.max_memory);
+  if (p.engine != NULL) {
+    nthprime_set_engine(context, p.engine);
+  }
+  if (p.checkpoint_file != NULL && nthprime_set_checkpoint_file(context, p.checkpoint_file) != 0) {
+    if (errno != EINVAL) {
+      perror(p.checkpoint_file);
+      exit(8);
+    }
+    /* keine oder eine beschdigte Checkpoint-Datei: sie ist nur ein Cache */
+    fprintf(stderr, "%s: no valid checkpoint file, ignored\n", p.checkpoint_file);
+  }
+  if (p.timings) {
+    memset(&timings, 0, sizeof(timings));
+    nthprime_set_timings(context, &timings);
+  }
+  if (p.progress_interval != 0) {
+    nthprime_set_progress(context, p.progress_interval, print_progress, NULL);
+  }
+
+  if (p.mode == MODE_PRIMES) {
+    Output output;
+#ifdef _WIN32
+    if (p.output_format == FORMAT_DELTA || p.output_format == FORMAT_RAW) {
+      _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+    start_output(&output, p.output_format);
+    if (p.batch_file != NULL) {
+      print_batch(context, p.batch_file, &output);
+    } else if (nthprime_primes(context, p.n_start, p.n, print_prime, &output) != 0) {
+      fprintf(stderr, "value %llu too large\n", p.n);
+      exit(2);
+    }
+    finish_output(&output);
+  } else if (p.mode == MODE_MERGE) {
+    print_merge(context, p.merge_files, p.merge_files_count);
+  } else if (p.mode >= MODE_PI) {
+    print_value(context, p.mode, p.x);
+  } else if (p.mode >= MODE_GAP_SEARCH) {
+    print_search(context, p);
+  } else {
+    print_statistics(context, p.mode, p.x_start, p.x);
+  }
+
+  if (p.timings) {
+    fflush(stdout);
+    print_timings(&timings);
+  }
+  nthprime_destroy(context);
   return 0;
 }
 
 /*------------------------------------------------------------------------------
-  n_start und n aus den Kommandozeilen-Parametern ermitteln
+  Optionen, n_start und n aus den Kommandozeilen-Parametern ermitteln
 ------------------------------------------------------------------------------*/
 Parameters get_parameters(int argc, char** argv) {
   Parameters p;
+  p.mode = MODE_PRIMES;
+  p.min_gap = 0;
+  p.threads_count = 1;
+  p.segment_bytes = 0;
+  p.max_memory = 0;
+  p.output_format = FORMAT_TEXT;
+  p.checkpoint_file = NULL;
+  p.timings = 0;
+  p.progress_interval = 0;
+  p.batch_file = NULL;
+  p.engine = NULL;
+  p.merge_files = NULL;
+  p.merge_files_count = 0;
+
+  if (argc == 2 && strcmp(argv[1], "--engines") == 0) {
+    print_engines();
+    exit(0);
+  }
+
+  while (argc > 1 && argv[1][0] == '-') {
+    if (strcmp(argv[1], "-t") == 0 && argc > 2) {
+      uint64 threads = atoul(argv[2]);
+      if (threads < 1 || threads > MAX_THREADS) {
+        usage();
+      }
+      p.threads_count = (uint32) threads;
+    } else if (strcmp(argv[1], "-s") == 0 && argc > 2) {
+      uint64 kib = atoul(argv[2]);
+      if (kib < 1 || kib > MAX_SEGMENT_KIB) {
+        usage();
+      }
+      p.segment_bytes = (uint32) kib * 1024;
+    } else if (strcmp(argv[1], "--max-memory") == 0 && argc > 2) {
+      uint64 mib = atoul(argv[2]);
+      if (mib < 1 || mib > MAX_MEMORY_MIB) {
+        usage();
+      }
+      p.max_memory = mib << 20;
+    } else if (strcmp(argv[1], "-p") == 0 && argc > 2) {
+      uint64 seconds = atoul(argv[2]);
+      if (seconds < 1 || seconds > 86400) {
+        usage();
+      }
+      p.progress_interval = (uint32) seconds;
+    } else if (strcmp(argv[1], "-c") == 0 && argc > 2) {
+      p.checkpoint_file = argv[2];
+    } else if (strcmp(argv[1], "-b") == 0 && argc > 2) {
+      p.batch_file = argv[2];
+    } else if (strcmp(argv[1], "--engine") == 0 && argc > 2) {
+      if (! is_engine(argv[2])) {
+        usage();
+      }
+      p.engine = argv[2];
+    } else if (strcmp(argv[1], "-f") == 0 && argc > 2) {
+      if (strcmp(argv[2], "text") == 0) {
+        p.output_format = FORMAT_TEXT;
+      } else if (strcmp(argv[2], "bare") == 0) {
+        p.output_format = FORMAT_BARE;
+      } else if (strcmp(argv[2], "delta") == 0) {
+        p.output_format = FORMAT_DELTA;
+      } else if (strcmp(argv[2], "raw") == 0) {
+        p.output_format = FORMAT_RAW;
+      } else {
+        usage();
+      }
+    } else if (strcmp(argv[1], "--timings") == 0) {
+      p.timings = 1;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--count") == 0) {
+      p.mode = MODE_COUNT;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--sum") == 0) {
+      p.mode = MODE_SUM;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--gaps-histogram") == 0) {
+      p.mode = MODE_GAPS;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--gaps") == 0 && argc > 2) {
+      if ((p.min_gap = atoul(argv[2])) < 1) {
+        usage();
+      }
+      p.mode = MODE_GAP_SEARCH;
+    } else if (strcmp(argv[1], "--record-gaps") == 0) {
+      p.mode = MODE_RECORDS;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--twins") == 0) {
+      p.mode = MODE_TWINS;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--triplets") == 0) {
+      p.mode = MODE_TRIPLETS;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--quadruplets") == 0) {
+      p.mode = MODE_QUADRUPLETS;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--shard") == 0) {
+      p.mode = MODE_SHARD;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--merge") == 0 && argc > 2) {
+      p.mode = MODE_MERGE;
+      p.merge_files = argv + 2;
+      p.merge_files_count = (uint32) (argc - 2);
+      return p;
+    } else if (strcmp(argv[1], "--pi") == 0) {
+      p.mode = MODE_PI;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--next") == 0) {
+      p.mode = MODE_NEXT;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--prev") == 0) {
+      p.mode = MODE_PREV;
+      argc += 1;
+      argv -= 1;
+    } else if (strcmp(argv[1], "--is-prime") == 0) {
+      p.mode = MODE_IS_PRIME;
+      argc += 1;
+      argv -= 1;
+    } else {
+      usage();
+    }
+    argc -= 2;
+    argv += 2;
+  }
+
+  if (p.batch_file != NULL) {
+    if (argc != 1 || p.mode != MODE_PRIMES) {
+      usage();
+    }
+    return p;
+  }
+
+  if (p.mode >= MODE_PI) {
+    if (argc != 2 || (p.x = atoul(argv[1])) < 1) {
+      usage();
+    }
+    return p;
+  }
+
+  if (p.mode != MODE_PRIMES) {
+    if (   argc != 2 && argc != 3
+        || argc == 2 && (   (p.x = atoul(argv[1])) < 1 || (p.x_start = 1) > p.x)
+        || argc == 3 && (   (p.x_start = atoul(argv[1])) < 1
+                         || (p.x       = atoul(argv[2])) < p.x_start)) {
+      usage();
+    }
+    return p;
+  }
 
   if (   argc != 2 && argc != 3
       || argc == 2 && (   (p.n_start = p.n = atoul(argv[1])) < 1)
       || argc == 3 && (   (p.n_start =       atoul(argv[1])) < 1
                        || (            p.n = atoul(argv[2])) < 1)) {
-     fprintf(stderr, "usage: nth-prime Number (in (0,2^64)) [Number/Count (in (0,2^64))]\n");
-    exit(1);
+    usage();
   }
   p = reinterprete_parameters(p);
   return p;
@@ -100,200 +529,697 @@ Parameters reinterprete_parameters(Parameters p) {
 }
 
 /*------------------------------------------------------------------------------
-  Gibt alle Primzahlen bis zur n-ten aus.
+  Gibt die Aufrufsyntax aus und beendet das Programm.
+------------------------------------------------------------------------------*/
+void usage(void) {
+  fprintf(stderr, "usage: nth-prime [-t Threads (in [1,%d])] [-s Segment-KiB (in [1,%d])]"
+                  " [--max-memory MiB (in [1,%d])]"
+                  " [-c Checkpoint-File] [-f text|bare|delta|raw] [-p Progress-Seconds]"
+                  " [--engine auto|Engine] [--timings]"
+                  " Number (in (0,2^64)) [Number/Count (in (0,2^64))]\n"
+                  "       nth-prime [-t Threads] [-s Segment-KiB] [--max-memory MiB]"
+                  " [-c Checkpoint-File] [-f text|bare|delta|raw] [-p Progress-Seconds]"
+                  " [--timings] -b Batch-File|-\n"
+                  "       nth-prime [-t Threads] [-s Segment-KiB] [--max-memory MiB]"
+                  " [-c Checkpoint-File] [-p Progress-Seconds] [--timings]"
+                  " --count|--sum|--gaps-histogram"
+                  " [Value (in (0,2^64))] Value (in (0,2^64))\n"
+                  "       nth-prime [-t Threads] [-s Segment-KiB] [--max-memory MiB]"
+                  " [-p Progress-Seconds] [--timings]"
+                  " --gaps Gap|--record-gaps|--twins|--triplets|--quadruplets"
+                  " [Value (in (0,2^64))] Value (in (0,2^64))\n"
+                  "       nth-prime [-t Threads] [-s Segment-KiB] [--max-memory MiB]"
+                  " [-c Checkpoint-File] [--timings] --pi|--next|--prev|--is-prime"
+                  " Value (in (0,2^64))\n"
+                  "       nth-prime [-t Threads] [-s Segment-KiB] [--max-memory MiB]"
+                  " [-c Checkpoint-File] [-p Progress-Seconds] [--timings]"
+                  " --shard [Value (in (0,2^64))] Value (in (0,2^64))\n"
+                  "       nth-prime [-c Checkpoint-File] --merge Shard-File|- [Shard-File ...]\n"
+                  "       nth-prime --engines\n",
+                  MAX_THREADS, MAX_SEGMENT_KIB, MAX_MEMORY_MIB);
+  exit(1);
+}
+
+/*------------------------------------------------------------------------------
+  Gibt Anzahl, Summe oder Abstnde aller Primzahlen in [a, b] aus.
+------------------------------------------------------------------------------*/
+void print_statistics(NthPrime* context, Mode mode, uint64 a, uint64 b) {
+  char str[40];
+  uint128 sum;
+  uint64 gaps[MAX_GAP / 2 + 1];
+  NthPrimeShard shard;
+
+  switch (mode) {
+    case MODE_COUNT:
+      printf("count = %llu\n", nthprime_count(context, a, b));
+      break;
+    case MODE_SUM:
+      nthprime_sum(context, a, b, &sum.hi, &sum.lo);
+      str[format_decimal_128(str, sum)] = 0;
+      printf("sum = %s\n", str);
+      break;
+    case MODE_GAPS:
+      nthprime_gaps_histogram(context, a, b, gaps);
+      for (uint32 g = 0; g <= MAX_GAP / 2; g++) {
+        if (gaps[g] != 0) {
+          printf("gap %u = %llu\n", g == 0 ? 1 : 2 * g, gaps[g]);
+        }
+      }
+      break;
+    case MODE_SHARD:
+      nthprime_shard(context, a, b, &shard);
+      printf("shard %llu %llu %llu %llu %llu\n", shard.a, shard.b, shard.count, shard.first,
+             shard.last);
+      break;
+    default:
+      break;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die gesuchten Abstnde oder Tupel in [x_start, x] aus, je Zeile
+  "p q gap" bzw. alle Primzahlen eines Tupels.
+------------------------------------------------------------------------------*/
+void print_search(NthPrime* context, Parameters p) {
+  static const uint64 triplets[2] = { NTHPRIME_TRIPLET_A, NTHPRIME_TRIPLET_B };
+  static const uint64 twins = NTHPRIME_TWINS;
+  static const uint64 quadruplets = NTHPRIME_QUADRUPLET;
+
+  switch (p.mode) {
+    case MODE_GAP_SEARCH:
+      nthprime_gaps(context, p.x_start, p.x, p.min_gap, print_gap, NULL);
+      break;
+    case MODE_RECORDS:
+      nthprime_record_gaps(context, p.x_start, p.x, print_gap, NULL);
+      break;
+    case MODE_TWINS:
+      nthprime_tuples(context, p.x_start, p.x, &twins, 1, print_tuple, NULL);
+      break;
+    case MODE_TRIPLETS:
+      nthprime_tuples(context, p.x_start, p.x, triplets, 2, print_tuple, NULL);
+      break;
+    case MODE_QUADRUPLETS:
+      nthprime_tuples(context, p.x_start, p.x, &quadruplets, 1, print_tuple, NULL);
+      break;
+    default:
+      break;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Fgt die Teilergebnisse aus allen Dateien zusammen und gibt je Bereich die
+  Nummern seiner Primzahlen (n1 < n0: keine), die Abstnde an den Grenzen
+  und die Gesamtzahl aus.
+------------------------------------------------------------------------------*/
+void print_merge(NthPrime* context, char** paths, uint32 paths_count) {
+  Shards shards;
+  memset(&shards, 0, sizeof(shards));
+  for (uint32 i = 0; i < paths_count; i++) {
+    read_shards(paths[i], &shards);
+  }
+  if (nthprime_merge_shards(context, shards.entries, shards.count) != 0) {
+    fprintf(stderr, "shards do not cover a contiguous range\n");
+    exit(1);
+  }
+
+  uint64 count = 0;
+  uint64 last = 0;
+  for (uint64 i = 0; i < shards.count; i++) {
+    const NthPrimeShard* shard = &shards.entries[i];
+    if (last != 0 && shard->first != 0) {
+      printf("gap %llu %llu %llu\n", last, shard->first, shard->first - last);
+    }
+    printf("range %llu %llu %llu %llu\n", shard->a, shard->b, shard->index,
+           shard->index + shard->count - 1);
+    count += shard->count;
+    last = shard->last != 0 ? shard->last : last;
+  }
+  printf("count = %llu\n", count);
+  free(shards.entries);
+}
+
+/*------------------------------------------------------------------------------
+  Hngt die Teilergebnisse der Datei path (Zeilen "shard a b count first
+  last" wie bei --shard; leere Zeilen und Zeilen mit # werden bersprungen)
+  an shards an.
+------------------------------------------------------------------------------*/
+void read_shards(const char* path, Shards* shards) {
+  FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    exit(8);
+  }
+
+  char line[256];
+  for (uint64 line_number = 1; fgets(line, sizeof(line), file) != NULL; line_number++) {
+    char* words[7];
+    uint32 words_count = 0;
+    for (char* word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+      words[words_count < 7 ? words_count : 6] = word;
+      words_count += 1;
+    }
+    if (words_count == 0 || words[0][0] == '#') {
+      continue;
+    }
+
+    NthPrimeShard shard;
+    if (   words_count != 6 || strcmp(words[0], "shard") != 0
+        || (shard.a = atoul(words[1])) < 1 || (shard.b = atoul(words[2])) < shard.a
+        || ((shard.count = atoul(words[3])) == 0) != ((shard.first = atoul(words[4])) == 0)
+        || ((shard.last = atoul(words[5])) == 0) != (shard.count == 0)
+        || shard.first > shard.last || shard.count > shard.b - shard.a + 1) {
+      fprintf(stderr, "%s: invalid shard in line %llu\n", path, line_number);
+      exit(1);
+    }
+    shard.index = 0;
+
+    if (shards->count == shards->capacity) {
+      shards->capacity = shards->capacity == 0 ? 1024 : 2 * shards->capacity;
+      if ((shards->entries = realloc(shards->entries,
+                                     sizeof(NthPrimeShard) * shards->capacity)) == NULL) {
+        perror("memory error");
+        exit(3);
+      }
+    }
+    shards->entries[shards->count++] = shard;
+  }
+
+  if (ferror(file)) {
+    perror(path);
+    exit(8);
+  }
+  if (file != stdin) {
+    fclose(file);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Gibt pi(x), die nchste oder vorige Primzahl (0: keine) oder 1 bzw. 0 fr
+  "x ist (k)eine Primzahl" aus.
+------------------------------------------------------------------------------*/
+void print_value(NthPrime* context, Mode mode, uint64 x) {
+  switch (mode) {
+    case MODE_PI:
+      printf("pi = %llu\n", nthprime_prime_pi(context, x));
+      break;
+    case MODE_NEXT:
+      printf("next = %llu\n", nthprime_next_prime(x));
+      break;
+    case MODE_PREV:
+      printf("prev = %llu\n", nthprime_prev_prime(x));
+      break;
+    case MODE_IS_PRIME:
+      printf("prime = %d\n", nthprime_is_prime(x));
+      break;
+    default:
+      break;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Callbacks fr print_search
+------------------------------------------------------------------------------*/
+int print_gap(void* data, uint64 p, uint64 q) {
+  (void) data;
+  printf("%llu %llu %llu\n", p, q, q - p);
+  return 0;
+}
+
+int print_tuple(void* data, uint64 p, uint64 pattern) {
+  (void) data;
+  for (uint32 d = 0; d < 64; d++) {
+    if (pattern >> d & 1) {
+      printf(d == 0 ? "%llu" : " %llu", p + d);
+    }
+  }
+  printf("\n");
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Beantwortet alle Abfragen der Datei path in einem Durchgang und gibt die
+  Primzahlen in der Reihenfolge der Abfragen aus.
+
+  Die Bibliothek meldet jede Primzahl nur einmal und aufsteigend; sie werden
+  mit ihrer Nummer gesammelt und danach fr jede Abfrage herausgesucht.
+  Jede Abfrage beginnt einen eigenen Chunk, bei -f delta beginnen ihre
+  Differenzen wieder bei 0.
 ------------------------------------------------------------------------------*/
-void print_primes(uint64 n) {
-  uint64 p = inverse_pi(n);
-  if (p == 0) {
+void print_batch(NthPrime* context, const char* path, Output* output) {
+  Queries queries = read_queries(path);
+  Answers answers;
+  memset(&answers, 0, sizeof(answers));
+
+  if (nthprime_primes_batch(context, queries.n_start, queries.n, queries.count,
+                            keep_answer, &answers) != 0) {
+    uint64 n = 0;
+    for (uint64 q = 0; q < queries.count; q++) {
+      n = queries.n[q] > n ? queries.n[q] : n;
+    }
     fprintf(stderr, "value %llu too large\n", n);
     exit(2);
   }
 
-  print_prime(2);
-  if (n == 1) {
-    return;
+  for (uint64 q = 0; q < queries.count; q++) {
+    uint64 i = find_answer(&answers, queries.n_start[q]);
+    pass_chunk(output);
+    output->chunks[output->filling].restart = 1;
+    for (uint64 index = queries.n_start[q]; index <= queries.n[q]; index++, i++) {
+      print_prime(output, index, answers.primes[i]);
+    }
   }
 
-  uint32 sqrts[5];
-  uint32 sqrts_top = calc_square_roots(p, sqrts);
-  uint32 sqrt_p = sqrts[0];
+  free(answers.indices);
+  free(answers.primes);
+  free(queries.n_start);
+  free(queries.n);
+}
 
-  uint32 prime_factors_count_estimated = estimate_number_of_primes_up_to(sqrt_p);
+/*------------------------------------------------------------------------------
+  Liest die Abfragen aus der Datei path (-: Standardeingabe), je Zeile eine
+  Nummer oder zwei wie auf der Kommandozeile (siehe reinterprete_parameters).
+  Bei einer ungltigen Zeile wird das Programm beendet.
+------------------------------------------------------------------------------*/
+Queries read_queries(const char* path) {
+  Queries queries;
+  memset(&queries, 0, sizeof(queries));
+  FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    exit(8);
+  }
 
-  uint32* primes = build_primes(prime_factors_count_estimated);
-  char* sieve = build_sieve(sqrt_p);
+  char line[256];
+  for (uint64 line_number = 1; fgets(line, sizeof(line), file) != NULL; line_number++) {
+    char* words[3];
+    uint32 words_count = 0;
+    for (char* word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+      words[words_count < 3 ? words_count : 2] = word;
+      words_count += 1;
+    }
+    if (words_count == 0 || words[0][0] == '#') {
+      continue;
+    }
+
+    Parameters p;
+    if (   words_count > 2
+        || (p.n_start = p.n = atoul(words[0])) < 1
+        || words_count == 2 && (p.n = atoul(words[1])) < 1) {
+      fprintf(stderr, "%s: invalid query in line %llu\n", path, line_number);
+      exit(1);
+    }
+    p = reinterprete_parameters(p);
+    add_query(&queries, p.n_start, p.n);
+  }
 
-  uint32 primes_top = calc_prime_factors(sqrts_top, sqrts, primes, sieve);
-  if (n > 2) {
-    calc_remaining_primes(n, sqrt_p, primes_top, primes, sieve);
+  if (ferror(file)) {
+    perror(path);
+    exit(8);
+  }
+  if (file != stdin) {
+    fclose(file);
   }
+  return queries;
 }
 
 /*------------------------------------------------------------------------------
-  Gibt eine Primzahl und deren Nummer aus.
+  Hngt eine Abfrage an.
+------------------------------------------------------------------------------*/
+void add_query(Queries* queries, uint64 n_start, uint64 n) {
+  if (queries->count == queries->capacity) {
+    queries->capacity = queries->capacity == 0 ? 1024 : 2 * queries->capacity;
+    queries->n_start = realloc(queries->n_start, sizeof(uint64) * queries->capacity);
+    queries->n = realloc(queries->n, sizeof(uint64) * queries->capacity);
+    if (queries->n_start == NULL || queries->n == NULL) {
+      perror("memory error");
+      exit(3);
+    }
+  }
+  queries->n_start[queries->count] = n_start;
+  queries->n[queries->count] = n;
+  queries->count += 1;
+}
 
-  Zahlen deren Nummer kleiner als n_start ist, werden nicht ausgegeben.
+/*------------------------------------------------------------------------------
+  Callback fr nthprime_primes_batch: sammelt die Primzahlen mit Nummer.
 ------------------------------------------------------------------------------*/
-void print_prime(uint64 prime_number) {
-  static uint64 primes_count = 0;
-  primes_count += 1;
-  if (primes_count >= n_start) {
-    printf("%llu. prime = %llu\n", primes_count, prime_number);
+int keep_answer(void* data, uint64 index, uint64 prime_number) {
+  Answers* answers = data;
+  if (answers->count == answers->capacity) {
+    answers->capacity = answers->capacity == 0 ? 4096 : 2 * answers->capacity;
+    answers->indices = realloc(answers->indices, sizeof(uint64) * answers->capacity);
+    answers->primes = realloc(answers->primes, sizeof(uint64) * answers->capacity);
+    if (answers->indices == NULL || answers->primes == NULL) {
+      perror("memory error");
+      exit(3);
+    }
+  }
+  answers->indices[answers->count] = index;
+  answers->primes[answers->count] = prime_number;
+  answers->count += 1;
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Sucht die Stelle der Primzahl mit der Nummer index in answers (binr).
+------------------------------------------------------------------------------*/
+uint64 find_answer(const Answers* answers, uint64 index) {
+  uint64 low = 0;
+  uint64 high = answers->count;
+  while (low < high) {
+    uint64 middle = low + (high - low) / 2;
+    if (answers->indices[middle] < index) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
   }
+  return low;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Laufzeiten der Phasen und den grten Speicherbedarf als eine
+  Zeile auf stderr aus (fr bench.sh).
+------------------------------------------------------------------------------*/
+void print_timings(const NthPrimeTimings* timings) {
+  fprintf(stderr, "timings: total=%.6f bound=%.6f base=%.6f segments=%.6f output=%.6f"
+                  " max_rss_kib=%llu\n",
+                  timings->total, timings->bound, timings->base, timings->segments,
+                  timings->output, get_max_rss_kib());
+}
+
+/*------------------------------------------------------------------------------
+  Gibt den Fortschritt einer Abfrage als eine Zeile auf stderr aus. Die
+  Restzeit (eta) wird aus dem erledigten Anteil der aktuellen Phase
+  hochgerechnet.
+------------------------------------------------------------------------------*/
+void print_progress(void* data, const NthPrimeProgress* progress) {
+  double eta = progress->done > 0
+             ? progress->phase_seconds * (1 - progress->done) / progress->done : 0;
+  double rate = progress->phase_seconds > 0 ? progress->numbers / progress->phase_seconds : 0;
+  double crossings = progress->segments > 0
+                   ? (double) progress->crossings / (double) progress->segments : 0;
+  (void) data;
+  fprintf(stderr, "progress: phase=%s seconds=%.0f done=%.2f%% z=%llu primes=%llu segments=%llu"
+                  " numbers_per_s=%.0f eta_s=%.0f crossings_per_segment=%.0f"
+                  " marking_s=%.3f scanning_s=%.3f\n",
+                  progress->phase == NTHPRIME_PHASE_PI ? "pi" : "sieve", progress->seconds,
+                  100 * progress->done, progress->z, progress->primes, progress->segments,
+                  rate, eta, crossings, progress->marking, progress->scanning);
 }
 
 /*------------------------------------------------------------------------------
-  Berechnet alle ungeraden Quadratwurzeln von p, solange bis der Wert 3 erreicht.
-  Statt 1 (== sqrt(3..8)) wird 3 verwendet. 
-  Zurckgegeben wird der Index der kleinsten (= Anzahl - 1).
+  Ermittelt den grten Speicherbedarf des Prozesses (Peak RSS) in KiB.
 ------------------------------------------------------------------------------*/
-uint32 calc_square_roots(uint64 p, uint32* sqrts) {
-  uint32 top = -1;
-  do {
-    sqrts[++top] = p = odd(integer_square_root(p));
-  } while (p > 3);
-  if (sqrts[top] == 1) {
-    sqrts[top] = 3;
+uint64 get_max_rss_kib(void) {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return counters.PeakWorkingSetSize / 1024;
+  }
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
   }
-  return top;
+#ifdef __APPLE__
+  return (uint64) usage.ru_maxrss / 1024;   /* dort in Bytes */
+#else
+  return (uint64) usage.ru_maxrss;
+#endif
+#endif
 }
 
 /*------------------------------------------------------------------------------
-  Baut ein Array fr die Primfaktoren auf, das ausreichend gro ist.
+  Legt die Chunks an und startet den Schreib-Thread.
 ------------------------------------------------------------------------------*/
-uint32* build_primes(uint32 prime_factors_count_estimated) {
-  uint32* primes;
-  size_t primes_size = sizeof(primes[0]) * prime_factors_count_estimated;
-  if ((primes = malloc(primes_size)) == NULL) {
+#ifdef _WIN32
+DWORD WINAPI writer_thread(LPVOID output) {
+  write_chunks(output);
+  return 0;
+}
+#else
+void* writer_thread(void* output) {
+  write_chunks(output);
+  return NULL;
+}
+#endif
+
+void start_output(Output* output, OutputFormat format) {
+  output->format = format;
+  output->size = 0;
+  output->previous_prime = 0;
+  output->filling = 0;
+  output->writing = 0;
+  output->pending = 0;
+  output->finished = 0;
+  if (   (output->buffer = malloc(OUTPUT_BUFFER_SIZE)) == NULL
+      || (output->chunks = malloc(sizeof(Chunk) * OUTPUT_CHUNKS)) == NULL) {
     perror("memory error");
     exit(3);
   }
-  return primes;
+  for (uint32 i = 0; i < OUTPUT_CHUNKS; i++) {
+    output->chunks[i].count = 0;
+    output->chunks[i].restart = 0;
+    if ((output->chunks[i].primes = malloc(sizeof(uint64) * OUTPUT_CHUNK_PRIMES)) == NULL) {
+      perror("memory error");
+      exit(3);
+    }
+  }
+#ifdef _WIN32
+  InitializeCriticalSection(&output->mutex);
+  InitializeConditionVariable(&output->changed);
+  if ((output->writer = CreateThread(NULL, 0, writer_thread, output, 0, NULL)) == NULL) {
+    fprintf(stderr, "thread error\n");
+    exit(6);
+  }
+#else
+  pthread_mutex_init(&output->mutex, NULL);
+  pthread_cond_init(&output->changed, NULL);
+  if (pthread_create(&output->writer, NULL, writer_thread, output) != 0) {
+    perror("thread error");
+    exit(6);
+  }
+#endif
 }
 
 /*------------------------------------------------------------------------------
-  Baut ein Sieb auf, das ausreichend gro und mit Nullen initialisiert ist.
-
-  Speicher wird in einer Grenordnung der Wurzel von n bentigt.
+  bergibt den letzten Chunk, wartet, bis alles geschrieben ist, und gibt
+  den Speicher frei.
 ------------------------------------------------------------------------------*/
-char* build_sieve(uint32 sqrt_p) {
-  char* sieve;
-  size_t sieve_size = sizeof(sieve[0]) * sqrt_p;  
-  if ((sieve = malloc(sieve_size)) == NULL) {
-    perror("memory error");
-    exit(4);
+void finish_output(Output* output) {
+  pass_chunk(output);
+  lock_output(output);
+  output->finished = 1;
+  signal_output(output);
+  unlock_output(output);
+#ifdef _WIN32
+  WaitForSingleObject(output->writer, INFINITE);
+  CloseHandle(output->writer);
+  DeleteCriticalSection(&output->mutex);
+#else
+  pthread_join(output->writer, NULL);
+  pthread_mutex_destroy(&output->mutex);
+  pthread_cond_destroy(&output->changed);
+#endif
+  for (uint32 i = 0; i < OUTPUT_CHUNKS; i++) {
+    free(output->chunks[i].primes);
   }
-  memset(sieve, 0, sieve_size);
-  return sieve;
+  free(output->chunks);
+  free(output->buffer);
 }
 
 /*------------------------------------------------------------------------------
-  Berechnet alle ungeraden Primzahlen <= sqrt(p).
-  Die Primzahlen werden auch ausgegeben.
-  Zurckgegeben wird der Index der grten Primzahl (= Anzahl - 2).
+  Gibt eine Primzahl und deren Nummer im gewhlten Format aus.
+
+  Das Sieb sammelt die Primzahlen nur im aktuellen Chunk; formatiert und
+  geschrieben werden sie im Schreib-Thread (write_chunks), whrend schon
+  weiter gesiebt wird. Ein Chunk wird bergeben, wenn er voll ist oder die
+  Nummern nicht mehr fortlaufend sind (bei -b).
 ------------------------------------------------------------------------------*/
-uint32 calc_prime_factors(uint32 sqrts_top, uint32* sqrts, uint32* primes, char* sieve) {
-  uint32 primes_top = 0;
-  primes[0] = 3;
-  print_prime(3);
+int print_prime(void* data, uint64 index, uint64 prime_number) {
+  Output* output = data;
+  Chunk* chunk = &output->chunks[output->filling];
+  if (   chunk->count == OUTPUT_CHUNK_PRIMES
+      || (chunk->count > 0 && index != chunk->index + chunk->count)) {
+    pass_chunk(output);
+    chunk = &output->chunks[output->filling];
+  }
+  if (chunk->count == 0) {
+    chunk->index = index;
+  }
+  chunk->primes[chunk->count++] = prime_number;
+  return 0;
+}
 
-  while (sqrts_top > 0) {
-    sqrts_top -= 1;
+/*------------------------------------------------------------------------------
+  bergibt den aktuellen Chunk (sofern nicht leer) an den Schreib-Thread und
+  wartet, bis der nchste im Ring frei ist. Das Sieb wartet also nur, wenn
+  die Ausgabe OUTPUT_CHUNKS Chunks zurckliegt.
+------------------------------------------------------------------------------*/
+void pass_chunk(Output* output) {
+  if (output->chunks[output->filling].count == 0) {
+    return;
+  }
+  lock_output(output);
+  output->pending += 1;
+  signal_output(output);
+  while (output->pending == OUTPUT_CHUNKS) {
+    wait_output(output);
+  }
+  unlock_output(output);
+  output->filling = (output->filling + 1) % OUTPUT_CHUNKS;
+}
 
-    /* Nicht-Primzahlen markieren */
-    for (uint32 i = 0; i <= primes_top; i++) {
-      for (uint32 j = (sqrts[sqrts_top + 1] - 3) / 2 + primes[i]
-                    - (sqrts[sqrts_top + 1] - primes[i]) / 2 % primes[i];
-           j <= (sqrts[sqrts_top] - 3) / 2;
-           j += primes[i]) {
-        sieve[j] = 1;
-      }
+/*------------------------------------------------------------------------------
+  Schreib-Thread: formatiert die bergebenen Chunks der Reihe nach und
+  schreibt sie, bis finish_output das Ende meldet.
+------------------------------------------------------------------------------*/
+void write_chunks(Output* output) {
+  for ( ; ; ) {
+    lock_output(output);
+    while (output->pending == 0 && ! output->finished) {
+      wait_output(output);
     }
-
-    /* Primzahlen notieren und ausgeben */
-    for (uint32 j = (sqrts[sqrts_top + 1] - 1) / 2; j <= (sqrts[sqrts_top] - 3) / 2; j++) {
-      if (sieve[j] == 0) {
-        primes[++primes_top] = j * 2 + 3;
-        print_prime(primes[primes_top]);
-      } else {
-        sieve[j] = 0;
-      }
+    if (output->pending == 0) {
+      unlock_output(output);
+      break;
     }
-  }
+    unlock_output(output);
 
-  return primes_top;
+    Chunk* chunk = &output->chunks[output->writing];
+    format_chunk(output, chunk);
+    chunk->count = 0;
+    chunk->restart = 0;
+    output->writing = (output->writing + 1) % OUTPUT_CHUNKS;
+
+    lock_output(output);
+    output->pending -= 1;
+    signal_output(output);
+    unlock_output(output);
+  }
+  flush_output(output);
 }
 
 /*------------------------------------------------------------------------------
-  Berechnet alle ungeraden Primzahlen > sqrt(p) und <= der n-ten.
-  Die Primzahlen werden auch ausgegeben.
+  Formatiert die Primzahlen eines Chunks in den Puffer von output, der
+  geschrieben wird, wenn er voll ist.
 ------------------------------------------------------------------------------*/
-void calc_remaining_primes(uint64 n, uint32 sqrt_p, uint32 primes_top, uint32* primes, char* sieve) { 
-  uint64 count_primes = primes_top + 2;
-
-  for (uint64 z = 2ULL + sqrt_p; ; z += 2ULL * sqrt_p) {
+void format_chunk(Output* output, const Chunk* chunk) {
+  if (chunk->restart) {
+    output->previous_prime = 0;
+  }
+  for (uint32 i = 0; i < chunk->count; i++) {
+    uint64 prime_number = chunk->primes[i];
+    if (output->size > OUTPUT_BUFFER_SIZE - MAX_OUTPUT_RECORD) {
+      flush_output(output);
+    }
 
-    /* Nicht-Primzahlen markieren */
-    for (uint32 i = 0; i <= primes_top; i++) {
-      uint32 j = primes[i] - 1 - (z - 2 - primes[i]) % (primes[i] * 2) / 2;
-      while (1) {
-        sieve[j] = 1;
-        if (j >= sqrt_p - primes[i]) {
-          break;
+    char* out = output->buffer + output->size;
+    switch (output->format) {
+      case FORMAT_TEXT:
+        out += format_decimal(out, chunk->index + i);
+        memcpy(out, ". prime = ", 10);
+        out += 10;
+        out += format_decimal(out, prime_number);
+        *out++ = '\n';
+        break;
+      case FORMAT_BARE:
+        out += format_decimal(out, prime_number);
+        *out++ = '\n';
+        break;
+      case FORMAT_DELTA: {
+        uint64 delta = prime_number - output->previous_prime;
+        output->previous_prime = prime_number;
+        while (delta >= 0x80) {
+          *out++ = (char) (delta & 0x7f | 0x80);
+          delta >>= 7;
         }
-        j += primes[i];
+        *out++ = (char) delta;
+        break;
       }
-    }
-    
-    /* Primzahlen notieren und ausgeben */
-    for (uint32 j = 0; j < sqrt_p; j++) {
-      if (sieve[j] == 0) {
-        print_prime(z + 2ULL * j);
-        count_primes += 1;
-        if (count_primes >= n) {
-          return;
+      case FORMAT_RAW:
+        for (uint32 j = 0; j < 8; j++) {
+          *out++ = (char) (prime_number >> 8 * j);
         }
-      } else {
-        sieve[j] = 0;
-      }
+        break;
     }
+    output->size = (uint32) (out - output->buffer);
   }
 }
 
-/*==============================================================================
-  allgemeine Funktionen
-==============================================================================*/
-
 /*------------------------------------------------------------------------------
-  inverse_pi(n) ist eine (obere) Abschtzung fr n-te Primzahl.
-
-  pi(x) ist die Funktion, die angibt, wie viele Primzahlen <= x es gibt.
-  x/ln(x) ist eine Nherung fr pi(x). Mit INV_xlnx als Umkehrfunktion gilt:
+  Sperren und Warten fr den Ring von output (Sieb und Schreib-Thread).
+------------------------------------------------------------------------------*/
+void lock_output(Output* output) {
+#ifdef _WIN32
+  EnterCriticalSection(&output->mutex);
+#else
+  pthread_mutex_lock(&output->mutex);
+#endif
+}
 
-       x/ln(x)           < pi(x)       = n (fr 10 < x < 2^64)
-  <=>  INV_xlnx(x/ln(x)) < INV_xlnx(n)
-  <=>  x                 < INV_xlnx(n)
+void unlock_output(Output* output) {
+#ifdef _WIN32
+  LeaveCriticalSection(&output->mutex);
+#else
+  pthread_mutex_unlock(&output->mutex);
+#endif
+}
 
-  Die Schtzung ist mindestens 2% zu gro (ab n > 3).
+void wait_output(Output* output) {
+#ifdef _WIN32
+  SleepConditionVariableCS(&output->changed, &output->mutex, INFINITE);
+#else
+  pthread_cond_wait(&output->changed, &output->mutex);
+#endif
+}
 
-  Wenn das Ergebnis zu gro ist, wird 0 zurckgegeben.
+void signal_output(Output* output) {
+#ifdef _WIN32
+  WakeAllConditionVariable(&output->changed);
+#else
+  pthread_cond_broadcast(&output->changed);
+#endif
+}
 
-  Vermutlich aus Grnden der Rechenungenauigkeit ist der grte mgliche
-  Eingabewert nur = 415.828.534.307.635.104.
-  In diesem Fall ist der Ausgabewert = 18.446.744.073.709.548.545 (knapp 2^64).
+/*------------------------------------------------------------------------------
+  Schreibt den Inhalt des Puffers von output (im Schreib-Thread).
 ------------------------------------------------------------------------------*/
-uint64 inverse_pi(uint64 n) {
-  if (n <= 2) {
-    return n == 1 ? 2 : 3;
+void flush_output(Output* output) {
+  if (   fwrite(output->buffer, 1, output->size, stdout) != output->size
+      || fflush(stdout) != 0) {
+    perror("output error");
+    exit(7);
   }
+  output->size = 0;
+}
 
-  uint64 x = 0;
-  for (uint64 delta = ~((~0ULL) >> 1); delta > 0; delta /= 2) {
-    if ((x - delta) / log((double) (x - delta)) >= n) {
-      x -= delta;
+/*------------------------------------------------------------------------------
+  Prft, ob name "auto" oder der Name eines Verfahrens der Bibliothek ist.
+------------------------------------------------------------------------------*/
+int is_engine(const char* name) {
+  const char* engine;
+  if (strcmp(name, "auto") == 0) {
+    return 1;
+  }
+  for (uint32 i = 0; (engine = nthprime_engine_name(i)) != NULL; i++) {
+    if (strcmp(name, engine) == 0) {
+      return 1;
     }
   }
-  return x;
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Namen aller Verfahren aus, je Zeile einen.
+------------------------------------------------------------------------------*/
+void print_engines(void) {
+  const char* engine;
+  for (uint32 i = 0; (engine = nthprime_engine_name(i)) != NULL; i++) {
+    printf("%s\n", engine);
+  }
 }
 
 /*------------------------------------------------------------------------------
@@ -314,21 +1240,69 @@ uint64 atoul(const char* str) {
 }
 
 /*------------------------------------------------------------------------------
-  Berechnet ISQRT = die ganzzahlige 32-Bit Qudratwurzel einer 64-Bit-Zahl.
-  Es gilt: ISQRT^2 <= x.
+  Schreibt x als Dezimalzahl (ohne abschlieende 0) nach str.
+  Zurckgegeben wird die Anzahl der Zeichen.
+
+  Es werden jeweils zwei Ziffern auf einmal aus einer Tabelle genommen.
 ------------------------------------------------------------------------------*/
-uint32 integer_square_root(uint64 x) {
-  uint32 y = (uint32) sqrt((double) x);
-  return ((uint64) y * (uint64) y <= x) ? y : (y - 1);
+uint32 format_decimal(char* str, uint64 x) {
+  static const char digits[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+  char buffer[20];
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+
+  while (x >= 100) {
+    uint32 i = (uint32) (x % 100) * 2;
+    x /= 100;
+    *--p = digits[i + 1];
+    *--p = digits[i];
+  }
+  if (x >= 10) {
+    *--p = digits[x * 2 + 1];
+    *--p = digits[x * 2];
+  } else {
+    *--p = (char) ('0' + x);
+  }
+
+  memcpy(str, p, end - p);
+  return (uint32) (end - p);
 }
 
 /*------------------------------------------------------------------------------
-  Berechnet eine Abschtzung EPRIM fr die Anzahl der Primzahlen <= x.
-  Es gilt: EPRIM >= pi(x)
+  Schreibt die 128-Bit-Zahl x als Dezimalzahl (ohne abschlieende 0) nach str.
+  Zurckgegeben wird die Anzahl der Zeichen.
+
+  x wird in 32-Bit-Stcken wiederholt durch 10^9 geteilt, die Reste ergeben
+  je 9 Ziffern.
 ------------------------------------------------------------------------------*/
-uint32 estimate_number_of_primes_up_to(uint32 x) {
-  return (uint32) (158 + (double) x
-                         / (log(x) - 1.052400915 - (log(4294967295U) - log(x))
-                                                 * 0.08149));
-//return (uint32) (158 + (double) x / (log(x) * 1.08149 - 2.859906955));
+uint32 format_decimal_128(char* str, uint128 x) {
+  if (x.hi == 0) {
+    return format_decimal(str, x.lo);
+  }
+
+  uint32 limbs[4] = { (uint32) (x.hi >> 32), (uint32) x.hi, (uint32) (x.lo >> 32), (uint32) x.lo };
+  uint32 chunks[5];
+  uint32 chunks_count = 0;
+  while (limbs[0] != 0 || limbs[1] != 0 || limbs[2] != 0 || limbs[3] != 0) {
+    uint64 rest = 0;
+    for (uint32 i = 0; i < 4; i++) {
+      uint64 current = rest << 32 | limbs[i];
+      limbs[i] = (uint32) (current / 1000000000);
+      rest = current % 1000000000;
+    }
+    chunks[chunks_count++] = (uint32) rest;
+  }
+
+  uint32 length = format_decimal(str, chunks[--chunks_count]);
+  while (chunks_count > 0) {
+    char digits[20];
+    uint32 digits_length = format_decimal(digits, chunks[--chunks_count]);
+    memset(str + length, '0', 9 - digits_length);
+    memcpy(str + length + 9 - digits_length, digits, digits_length);
+    length += 9;
+  }
+  return length;
 }
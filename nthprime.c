@@ -0,0 +1,5590 @@
+/*------------------------------------------------------------------------------
+  N T H P R I M E . C
+
+  Bibliothek libnthprime: n-te Primzahl, pi(x) und alle Primzahlen (< 2^64)
+  in einem Bereich, einzeln oder als Anzahl, Summe und Abstnde.
+  Die Schnittstelle ist in nthprime.h beschrieben.
+
+  Es gibt keine globalen Variablen: die Einstellungen stehen im Kontext
+  (NthPrime), alles andere gehrt zu einer einzelnen Abfrage (Query) und
+  liegt auf dem Stack oder im Heap. So knnen mehrere Abfragen gleichzeitig
+  in einem Prozess laufen.
+
+  Compile: cc -O2 -c nthprime.c
+     oder: cl /nologo /O2 /c nthprime.c
+------------------------------------------------------------------------------*/
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "nthprime.h"
+
+/* Kerne mit Vektorbefehlen werden nur auf x86 bersetzt und zur Laufzeit
+   ausgewhlt; GCC und Clang brauchen dafr das target-Attribut. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define X86_KERNELS
+#define TARGET(features) __attribute__((target(features)))
+#define POPCOUNT_64(x) ((uint64) __builtin_popcountll(x))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define X86_KERNELS
+#define TARGET(features)
+#define POPCOUNT_64(x) ((uint64) __popcnt64(x))
+#endif
+
+/*------------------------------------------------------------------------------
+  Datentypen
+------------------------------------------------------------------------------*/
+typedef unsigned long long int uint64;
+typedef unsigned int           uint32;
+typedef unsigned char          uint8;
+
+#define PRESIEVE_PATTERNS 2      /* Muster fr 7 * 11 * 13 * 17 und 19 * 23 * 29 */
+
+#ifdef _WIN32
+typedef HANDLE           Thread;
+typedef CRITICAL_SECTION Mutex;
+#else
+typedef pthread_t        Thread;
+typedef pthread_mutex_t  Mutex;
+#endif
+
+typedef enum {
+  MODE_PRIMES,
+  MODE_COUNT,
+  MODE_SUM,
+  MODE_GAPS,
+  MODE_GAP_SEARCH,       /* Suchen: Abstnde >= min_gap, */
+  MODE_RECORDS,          /* Rekordabstnde und */
+  MODE_TUPLES            /* Tupel (siehe Search) */
+} Mode;
+
+typedef enum {
+  PHASE_BOUND,
+  PHASE_BASE,
+  PHASE_SEGMENTS,
+  PHASE_OUTPUT
+} Phase;
+
+typedef struct {
+  uint64 hi;
+  uint64 lo;
+} uint128;
+
+typedef struct {
+  const char* name;
+  uint64 (*count_bits)(const uint8* bytes, uint32 size);
+  void   (*and_bytes)(uint8* target, const uint8* a, const uint8* b, uint32 size);
+} Kernels;
+
+typedef struct Query Query;
+
+/* Verfahren zum Melden der Primzahlen */
+typedef struct {
+  const char* name;
+  int  (*primes)(Query* query, uint64 n);   /* n_start-te bis n-te (-1: n zu gro) */
+  void (*primes_between)(Query* query, uint64 a, uint64 b);
+} Engine;
+
+typedef struct {
+  uint8* bytes;          /* Sieb ab 0 ohne die Vielfachen der Primzahlen */
+  uint32 period;         /* Produkt der Primzahlen = Lnge in Bytes */
+} Pattern;
+
+typedef struct {
+  uint64 x;
+  uint64 pi;             /* Anzahl der Primzahlen <= x */
+} Checkpoint;
+
+typedef struct {
+  FILE*   file;          /* zum Anhngen neuer Checkpoints */
+  void*   map;           /* Abbildung der Datei im Speicher */
+  uint64  map_size;
+#ifdef _WIN32
+  HANDLE  mapping;
+#endif
+  const Checkpoint* mapped;  /* nach x sortierter Anfang der Datei (in map) */
+  uint64  mapped_count;
+  Checkpoint* added;     /* alle brigen, nach x sortiert */
+  uint64  added_count;
+  uint64  added_capacity;
+  Mutex   mutex;         /* schtzt added und file */
+} Checkpoints;
+
+struct NthPrime {
+  uint32 threads_count;
+  uint32 segment_bytes;
+  const Kernels* kernels;
+  const Engine* engine;      /* NULL: automatisch (choose_engine) */
+  uint64 max_memory;         /* ungefhre Obergrenze in Bytes (0: keine) */
+  uint64 physical_memory;    /* Hauptspeicher in Bytes (0: unbekannt) */
+  Pattern presieve[PRESIEVE_PATTERNS];
+  Checkpoints* checkpoints;  /* NULL: ohne Checkpoint-Datei */
+  NthPrimeTimings* timings;  /* NULL: ohne Messung */
+  NthPrimeProgressCallback progress;  /* NULL: ohne Fortschritt */
+  void*  progress_data;
+  double progress_interval;
+};
+
+struct Query {
+  uint32 threads_count;
+  uint32 segment_bytes;
+  const Kernels* kernels;
+  const Pattern* presieve;
+  uint64 max_memory;     /* 0: keine Obergrenze */
+  uint64 pi_memory;      /* Obergrenze fr prime_pi (0: keine) */
+  Mode   mode;
+  uint64 n_start;        /* kleinste Nummer, die gemeldet wird */
+  NthPrimeCallback callback;
+  void*  data;
+  int    stopped;        /* callback hat abgebrochen */
+  Checkpoints* checkpoints;  /* NULL, wenn die Nummern nicht absolut sind */
+  NthPrimeTimings timings;   /* Laufzeiten dieser Abfrage */
+  NthPrimeTimings* timings_total;  /* NULL: ohne Messung */
+  double started;        /* Beginn der Abfrage (Sekunden) */
+  NthPrimeProgressCallback progress;  /* NULL: ohne Fortschritt */
+  void*  progress_data;
+  double progress_interval;
+  double progress_next;  /* Zeitpunkt des nchsten Berichts */
+  double phase_started;
+  uint64 segments;       /* gesiebte Segmente */
+  uint64 crossings;      /* gestrichene Vielfache */
+};
+
+typedef struct {
+  uint64  index;         /* Byte des nchsten Vielfachen (relativ zum Segment) */
+  uint32  factor;        /* p / 30 */
+  uint8   rest;          /* Bit von p % 30 */
+  uint8   wheel_index;   /* Bit von q % 30 fr das nchste Vielfache p * q */
+} SievingPrime;
+
+typedef struct {
+  SievingPrime* entries;
+  uint32 count;
+  uint32 capacity;
+} Bucket;
+
+/* Ungerade Primzahlen bis zur Wurzel: einzeln in primes, mit Speichergrenze
+   nur die kleinen, alle greren dann als halbe Abstnde in gaps */
+typedef struct {
+  uint32* primes;
+  uint32  primes_top;    /* Index der grten in primes */
+  uint8*  gaps;          /* NULL: alle in primes */
+  uint64  gaps_count;    /* gaps[i] = (q - p) / 2 ab p = primes[primes_top] */
+  uint32  sqrt_x;        /* (ungerade) Wurzel, bis zu der sie reichen */
+} Factors;
+
+typedef struct {
+  Mode    mode;
+  const Kernels* kernels;
+  const Pattern* presieve;
+  uint64  low;           /* Anfang des Blocks (Vielfaches von 30) */
+  uint64  z;             /* erste zu bercksichtigende Zahl (>= low) */
+  uint64  count;         /* Anzahl der Primzahlen >= z im Block */
+  uint32  bytes;         /* Gre des Siebs in Bytes (je 30 Zahlen) */
+  uint32  primes_top;
+  uint32* primes;
+  const uint8* factor_gaps;  /* NULL: groe Primzahlen in Eimern, sonst */
+  uint64  factor_gaps_count; /* die nach primes (siehe cross_off_large) */
+  uint8*  sieve;
+  SievingPrime* sieving_primes;
+  uint64  sieving_primes_low;  /* Anfang, auf den sich sieving_primes beziehen */
+  uint32  segment_bytes;
+  uint32  large_start;   /* Index der ersten groen Primzahl in primes */
+  uint32  large_next;    /* Index der nchsten groen Primzahl, die noch fehlt */
+  Bucket* buckets;       /* Ring von Eimern, einer je Segment */
+  uint32  buckets_mask;
+  uint64  segment_number;
+  uint64  z_end;         /* letzte zu bercksichtigende Zahl */
+  uint64  crossings;     /* gestrichene Vielfache seit dem letzten Abholen */
+  uint128 sum;           /* Summe der Primzahlen im Block (nur MODE_SUM) */
+  uint64  first;         /* erste und letzte Primzahl im Block und */
+  uint64  last;          /* Histogramm der Abstnde (nur MODE_GAPS) */
+  uint64* gaps;
+  const struct Search* search;  /* Fundstellen einer Suche als Paare (p, q) */
+  uint64* found;         /* bzw. (p, Index des Musters), siehe */
+  uint64  found_count;   /* calc_block_search */
+  uint64  found_size;
+} Block;
+
+/* Muster eines Tupels im Rad-Sieb (siehe build_tuple) */
+typedef struct {
+  uint64  pattern;       /* Bit d: p + d gehrt dazu */
+  uint32  starts;        /* Bit k: p % 30 = wheel[k] ist mglich */
+  uint32  shifts_count;  /* Anzahl der Primzahlen nach p */
+  uint8   shifts[8][64]; /* deren Bits relativ zum Bit von p, je k */
+} Tuple;
+
+/* Zustand einer Suche nach Abstnden oder Tupeln */
+typedef struct Search {
+  Mode    mode;          /* MODE_GAP_SEARCH, MODE_RECORDS oder MODE_TUPLES */
+  uint64  min_gap;
+  uint64  record;        /* grter bisheriger Abstand */
+  uint64  last;          /* letzte Primzahl (0: noch keine) */
+  uint64  b;             /* Ende des Bereichs */
+  Tuple   tuples[NTHPRIME_MAX_PATTERNS];
+  uint32  tuples_count;
+  uint64  tail;          /* letzte 8 Bytes des vorigen Blocks */
+  uint64  tail_low;      /* und deren Anfang */
+  NthPrimeGapCallback gap_callback;
+  NthPrimeTupleCallback tuple_callback;
+  void*   data;
+  int     stopped;       /* callback hat abgebrochen */
+} Search;
+
+typedef struct {
+  uint64  count;
+  uint128 sum;
+  uint64  last;          /* letzte Primzahl (0: noch keine) */
+  uint64* gaps;          /* gaps[g / 2]: Anzahl der Abstnde g (nur MODE_GAPS) */
+  Search* search;        /* NULL: keine Suche */
+} Statistics;
+
+typedef struct {
+  uint64* primes;
+  uint64  size;
+  uint64  count;
+} Fill;
+
+typedef struct {
+  uint64  n_start;
+  uint64  n;
+} Range;
+
+typedef struct {
+  Query*  query;
+  Range*  ranges;        /* nach n_start sortiert, ohne berlappungen */
+  uint64  current;       /* Bereich, in dem die nchste Primzahl liegt */
+  uint64  last;          /* letzter Bereich des laufenden Durchgangs */
+  double  jump_seconds;  /* Dauer des letzten Sprungs mit pi(x) (0: noch keiner) */
+  uint64  jump_x;        /* dessen x */
+  NthPrimeCallback callback;
+  void*   data;
+} Batch;
+
+/* Generator des inkrementellen Siebs fr die ungeraden Primzahlen > number */
+typedef struct Generator {
+  uint64  number;        /* zuletzt geprfte ungerade Zahl */
+  uint64  i;             /* deren Platz in ring */
+  uint64  ring_mask;
+  uint32* ring;          /* je ein Primfaktor fr knftige Vielfache */
+  uint32  next_base;     /* nchste Primzahl, die noch nicht im Ring steht, */
+  uint64  next_square;   /* und deren Quadrat (0: jenseits von 2^64) */
+  struct Generator* base;  /* liefert die Primzahlen nach next_base (NULL: noch keiner) */
+} Generator;
+
+/* Tabellen von prime_pi bis y */
+typedef struct {
+  uint64  x;
+  uint64  y;
+  uint64  z;             /* x / y: so weit wird gesiebt */
+  uint64  sqrt_x;
+  uint32  a;             /* pi(y) */
+  uint32  c;             /* phi(v, c) steht in phi_table */
+  uint32  b_sqrt_y;      /* pi(sqrt(y)) */
+  uint32  b_sieve;       /* gesiebt wird mit primes[2..b_sieve] (bis sqrt(z)) */
+  uint32* primes;        /* primes[1..a] = 2, 3, 5, ... */
+  uint64* prime_bits;    /* Bit j von prime_bits[i]: 128 i + 2 j + 1 ist prim */
+  uint32* prime_counts;  /* prime_counts[i]: Primzahlen < 128 i, mit der 2 */
+  int*    factors;       /* factors[m / 2]: mu(m) * kleinster Primfaktor (ungerade m <= y) */
+  uint64* leaf_ends;     /* leaf_ends[b]: Schranke fr x / (p_b m) der schweren Bltter */
+  uint32* phi_table;     /* phi_table[v] = phi(v, c) fr v < phi_period */
+  uint64* pattern;       /* Bit k: 2 k + 1 hat keinen Teiler p_2..p_c (mit Wiederholung von Wort 0) */
+  uint32  pattern_words; /* Periode in Wrtern (p_2 * ... * p_c) */
+  uint32  phi_period;    /* p_1 * ... * p_c */
+  uint32  phi_totient;   /* phi(phi_period, c) */
+} PiTables;
+
+/* Teilbereich [low, high) des Siebs von prime_pi, den ein Thread bearbeitet */
+typedef struct {
+  const PiTables* tables;
+  const Kernels* kernels;
+  uint32  segment_bits;  /* ungerade Zahlen je Segment */
+  uint32  piece;         /* Nummer des Teilbereichs */
+  uint32  pieces;        /* Anzahl aller Teilbereiche */
+  uint64  low;           /* ungerade */
+  uint64  high;
+  uint64* sieve;         /* Bit j: low + 2 j ist noch nicht gestrichen */
+  uint32* counters;      /* nicht gestrichene Bits je PI_COUNTER_BITS */
+  uint64* multiples;     /* multiples[b]: nchstes ungerades Vielfaches von p_b */
+  uint64* leaf_signs;    /* leaf_signs[b]: Summe von -mu(m) der schweren Bltter von p_b */
+  uint64* phi_counts;    /* phi_counts[b]: vor p_b nicht gestrichene Zahlen im Teilbereich */
+  uint64  leaves;        /* Bltter (die schweren mit phi ab low) */
+  uint64  p2;            /* Summe der nicht gestrichenen Zahlen ab low bis x / p */
+  uint64  p2_count;      /* Anzahl dieser Primzahlen p */
+  uint64  survivors;     /* nach dem Sieben nicht gestrichene Zahlen */
+  uint64* window;        /* Sieb fr die Primzahlen p von P2 */
+  uint32* window_primes; /* deren Primzahlen, absteigend */
+  uint32  window_count;
+  uint32  window_next;
+  uint64  window_top;    /* grte Zahl, die noch in kein Fenster kam */
+} PiRange;
+
+struct NthPrimeIterator {
+  NthPrime context;
+  uint64  next_from;     /* next liefert die kleinste Primzahl >= next_from */
+  uint64  prev_below;    /* prev liefert die grte Primzahl < prev_below */
+  uint64  low;           /* Fenster [low, high], dessen Primzahlen in primes */
+  uint64  high;          /* stehen (high < low: noch keins) */
+  uint64* primes;
+  uint64  count;
+  uint64  capacity;
+  Factors factors;       /* Primfaktoren fr alle Fenster bis factors_limit */
+  uint64  factors_limit;
+};
+
+/*------------------------------------------------------------------------------
+  Prototypen
+------------------------------------------------------------------------------*/
+static Query make_query(NthPrime* context, Mode mode, uint64 n_start,
+                        NthPrimeCallback callback, void* data);
+static void finish_query(Query* query);
+static void add_timing(Query* query, Phase phase, double start);
+static void report_progress(Query* query, int phase, double done, uint64 z, uint64 numbers,
+                            uint64 primes);
+static int report_prime(Query* query, uint64 index, uint64 prime_number);
+static int keep_prime(void* data, uint64 index, uint64 prime_number);
+static int fill_prime(void* data, uint64 index, uint64 prime_number);
+static int append_prime(void* data, uint64 index, uint64 prime_number);
+static int batch_prime(void* data, uint64 index, uint64 prime_number);
+static uint32 detect_l1_cache_size(void);
+static uint64 detect_physical_memory(void);
+static const Kernels* select_kernels(void);
+static void build_pattern(Pattern* pattern, const uint32* primes);
+static const Engine* choose_engine(NthPrime* context, uint64 x);
+static int calc_primes(Query* query, uint64 n);
+static void sieve_primes_between(Query* query, uint64 a, uint64 b);
+static void calc_primes_between(Query* query, uint64 a, uint64 b, const Factors* factors);
+static void calc_batch(Query* query, Batch* batch, uint64 ranges_count);
+static uint64 merge_ranges(Range* ranges, uint64 ranges_count);
+static int compare_ranges(const void* a, const void* b);
+static int prefer_sweep(Batch* batch, uint64 n, uint64 n_next);
+static uint32 find_primes_top(const uint32* primes, uint32 primes_top, uint32 x);
+static uint64 calc_dense_limit(const Query* query, uint64 x);
+static void build_prime_factors(uint64 x, uint64 dense_limit, Factors* factors);
+static void free_prime_factors(Factors* factors);
+static uint32* build_primes(uint32 prime_factors_count_estimated);
+static uint8* build_gaps(uint32 gaps_count_estimated);
+static uint64* build_multiples(uint32 count);
+static char* build_sieve(uint32 size);
+static uint8* build_wheel_sieve(uint32 bytes);
+static SievingPrime* build_sieving_primes(uint32 count);
+static void calc_prime_factors(Factors* factors, uint64 dense_limit, uint64* next, char* sieve);
+static void calc_remaining_primes(Query* query, uint64 n, uint64 z_start, uint64 z_end,
+                                  uint64 count_primes, const Factors* factors);
+static uint64 report_block_primes(Query* query, Block* block, uint64 count_primes, uint64 n);
+static uint32 build_blocks(Query* query, Block* blocks, uint64 low_start, uint64 high,
+                           const Factors* factors);
+static void free_blocks(Query* query, Block* blocks);
+static void sieve_blocks(Query* query, Block* blocks, uint64 low, uint64 z_start, uint64 z_end);
+static void add_block_checkpoints(Checkpoints* checkpoints, Block* block, uint64 count_primes);
+static Statistics get_statistics(NthPrime* context, Mode mode, uint64 a, uint64 b, uint64* gaps);
+static void calc_statistics(Query* query, uint64 a, uint64 b, Statistics* statistics);
+static void sieve_statistics(Query* query, uint64 a, uint64 b, Statistics* statistics);
+static void add_prime_to_statistics(Statistics* statistics, uint64 prime);
+static void add_block_to_statistics(Statistics* statistics, Block* block);
+static void add_gap(uint64* gaps, uint64 gap);
+static void calc_block_statistics(Block* block);
+static void search_primes(NthPrime* context, Search* search, uint64 a, uint64 b);
+static void build_tuple(Tuple* tuple, uint64 pattern);
+static void add_prime_to_search(Search* search, uint64 prime);
+static void add_block_to_search(Search* search, Block* block);
+static void finish_search(Search* search);
+static void report_gap(Search* search, uint64 p, uint64 q);
+static void report_tuples(Search* search, uint64 low, uint64 x, uint64 y);
+static uint64 match_tuple(const Tuple* tuple, uint64 x, uint64 y);
+static void calc_block_search(Block* block);
+static void add_found(Block* block, uint64 a, uint64 b);
+static int is_small_prime(uint64 x);
+static int compare_shards(const void* a, const void* b);
+static void sieve_block(Block* block);
+static void presieve_segment(Block* block, uint8* sieve, uint64 segment_low);
+static void init_block(Block* block);
+static void init_sieving_prime(SievingPrime* sieving_prime, uint32 prime, uint64 low);
+static void add_large_sieving_primes(Block* block, uint64 segment_low);
+static uint32 cross_off_bucket(Block* block, uint8* sieve);
+static uint64 cross_off_large(Block* block);
+static uint32 cross_off_block(Block* block, uint32 prime);
+static void push_bucket(Block* block, uint64 segment_number, SievingPrime sieving_prime);
+static uint32 cross_off(SievingPrime* sieving_prime, uint8* sieve, uint32 bytes);
+static Thread start_block_thread(Block* block);
+static void join_block_thread(Thread thread);
+static void sieve_window(NthPrimeIterator* iterator, uint64 low, uint64 high);
+static uint64 find_prime(NthPrimeIterator* iterator, uint64 x);
+static uint64 move_iterator(NthPrimeIterator* iterator, uint64 prime);
+static uint64 calc_window_start(Query* query, uint64 n, const Factors* factors, uint64* count_primes);
+static int generate_primes(Query* query, uint64 n);
+static void generate_primes_between(Query* query, uint64 a, uint64 b);
+static Generator* create_generator(uint64 start);
+static void destroy_generator(Generator* generator);
+static uint64 generate_prime(Generator* generator);
+static void add_base_prime(Generator* generator, uint64 multiple);
+static void move_factor(Generator* generator, uint64 j, uint32 factor);
+static void grow_ring(Generator* generator, uint64 size);
+static uint32* build_ring(uint64 size);
+static Checkpoints* open_checkpoints(const char* path);
+static int map_checkpoints(Checkpoints* checkpoints, uint64 count);
+static void close_checkpoints(Checkpoints* checkpoints);
+static int check_checkpoints(const Checkpoints* checkpoints);
+static int is_plausible_checkpoint(Checkpoint checkpoint);
+static int find_checkpoint(Checkpoints* checkpoints, uint64 x, uint64 n, Checkpoint* found);
+static int find_table_checkpoint(uint64 x, uint64 n, Checkpoint* found);
+static int find_known_pi(const Query* query, uint64 x, uint64 n, Checkpoint* found);
+static void add_checkpoint(Checkpoints* checkpoints, uint64 x, uint64 pi);
+static int insert_checkpoint(Checkpoints* checkpoints, Checkpoint checkpoint);
+static void append_checkpoint(Checkpoints* checkpoints, Checkpoint checkpoint);
+static int lock_checkpoint_file(FILE* file, int lock);
+static uint64 find_checkpoint_index(const Checkpoint* entries, uint64 count, uint64 x);
+static void lock_checkpoints(Checkpoints* checkpoints);
+static void unlock_checkpoints(Checkpoints* checkpoints);
+static uint64 lookup_prime_pi(Query* query, uint64 x);
+static uint64 calc_pi_limit(const Query* query);
+static uint64 estimate_pi_memory(const Query* query, uint64 x);
+static int prefer_sieve(uint64 distance, uint64 x);
+static uint64 prime_pi(Query* query, uint64 x);
+static uint64 choose_pi_y(uint64 x);
+static uint32 choose_pi_segment_bits(const Query* query, uint64 z);
+static uint64 calc_prime_pi(Query* query, uint64 x, uint64 y);
+static void build_pi_tables(PiTables* tables, uint64 x, uint64 y);
+static void free_pi_tables(PiTables* tables);
+static uint64 small_prime_pi(const PiTables* tables, uint64 v);
+static uint64 calc_ordinary_leaves(const PiTables* tables);
+static uint64 calc_easy_leaves(const PiTables* tables, uint32 b);
+static void init_pi_range(PiRange* range, const PiTables* tables, const Kernels* kernels,
+                          uint32 segment_bits, uint32 pieces);
+static void free_pi_range(PiRange* range);
+static void sieve_pi_range(PiRange* range);
+static void sieve_pi_segment(PiRange* range, uint64 low, uint64 high);
+static uint64 count_pi_segment(PiRange* range, uint32 words);
+static uint32 cross_off_pi(PiRange* range, uint32 b, uint64 low, uint32 bits, uint32* counters);
+static void add_hard_leaves(PiRange* range, uint32 b, uint64 low, uint64 high);
+static uint64 count_pi_survivors(const PiRange* range, uint64 j, uint32* block, uint64* before);
+static void add_p2_primes(PiRange* range, uint64 low, uint64 high);
+static uint64 next_p2_prime(PiRange* range);
+static Thread start_pi_thread(PiRange* range);
+static uint64 inverse_pi(uint64 n);
+static uint64 inverse_pi_lower(uint64 n);
+static uint64 inverse_li(uint64 n);
+static long double li(long double x);
+static int miller_rabin(uint64 n);
+static uint64 montgomery_multiply(uint64 a, uint64 b, uint64 n, uint64 n_inverse);
+static uint32 sieve_local(uint64 low, uint32 bytes, uint8* sieve);
+static uint128 multiply_64(uint64 a, uint64 b);
+static void add_128(uint128* a, uint128 b);
+static uint32 integer_square_root(uint64 x);
+static double get_seconds(void);
+static uint32 estimate_number_of_primes_up_to(uint32 x);
+static uint64 load_bits(const uint8* bytes, uint32 size);
+static uint32 lowest_bit(uint64 bits);
+static uint64 count_bits(const uint8* bytes, uint32 size);
+static void and_bytes(uint8* target, const uint8* a, const uint8* b, uint32 size);
+#ifdef X86_KERNELS
+static uint64 count_bits_popcnt(const uint8* bytes, uint32 size);
+static uint64 count_bits_avx2(const uint8* bytes, uint32 size);
+static void and_bytes_avx2(uint8* target, const uint8* a, const uint8* b, uint32 size);
+#endif
+
+/*------------------------------------------------------------------------------
+  Macros
+------------------------------------------------------------------------------*/
+#define odd(n) ((n - 1) | 1)
+
+/*------------------------------------------------------------------------------
+  Konstanten
+------------------------------------------------------------------------------*/
+#define PI_ENGINE_MIN_N 10000000ULL  /* ab hier lohnt sich der Sprung mit pi(x) */
+#define MAX_THREADS     NTHPRIME_MAX_THREADS
+#define MAX_SEGMENT_KIB NTHPRIME_MAX_SEGMENT_KIB
+#define DEFAULT_SEGMENT_BYTES 32768  /* falls der L1-Cache unbekannt ist */
+#define SEGMENTS_PER_BLOCK 16
+#define MAX_BOUNDED_BLOCK_BYTES (1U << 30)  /* grter Block mit Speichergrenze */
+#define BASE_CHUNK       65536       /* ungerade Zahlen je Stck beim Sieben bis zur Wurzel */
+#define MIN_DENSE_LIMIT  65536       /* so weit stehen Primfaktoren immer einzeln */
+#define MIN_SEGMENT_BYTES 1024       /* kleinere Segmente machen alle Primfaktoren gro */
+#define SCAN_BYTES       512         /* Stcke, die beim Melden bersprungen werden */
+#define MAX_GAP          NTHPRIME_MAX_GAP
+#define MAX_PATTERNS     NTHPRIME_MAX_PATTERNS
+#define LARGEST_PRIME    18446744073709551557ULL  /* grte Primzahl < 2^64 */
+#define LOCAL_BYTES      64          /* Fenster (je 30 Zahlen) fr next/prev_prime */
+#define TUPLE_SEAM_BYTES 8           /* Ende eines Blocks, das erst mit dem nchsten geprft wird */
+#define NEVER            (~0ULL)     /* Index eines Vielfachen jenseits von 2^64 */
+#define PRESIEVE_NEXT    9           /* primes[9] = 31 wird als erste gesiebt */
+#define MAX_PI_N         425656284035217743ULL  /* pi(2^64 - 1) */
+#define ITERATOR_WINDOW  (1ULL << 21) /* Zahlen je Fenster des Iterators */
+#define MIN_RING_SIZE    64          /* Anfangsgre des Rings im inkrementellen Sieb */
+#define PROGRESS_PRIMES  (1ULL << 20) /* Primzahlen zwischen zwei Berichten (inkrementell) */
+#define INCREMENTAL_MAX_X 800       /* bis hier whlt choose_engine das inkrementelle Sieb */
+#define CHECKPOINT_STRIDE (30ULL << 20) /* Abstand der Checkpoints */
+#define CHECKPOINT_MAGIC  "NTHPRIME-PI-V1\n"
+#define CHECKPOINT_HEADER 16         /* Lnge von CHECKPOINT_MAGIC mit 0 */
+#define CHECKPOINT_LOCK   0x7fffffffL  /* beim Anhngen gesperrtes Byte der Datei */
+#define PI_TABLE_STRIDE (30ULL << 21) /* Abstand der Werte in pi_table (2 * CHECKPOINT_STRIDE) */
+#define PI_TABLE_SIZE   4096         /* pi_table reicht bis 4095 * PI_TABLE_STRIDE */
+#define PI_MIN_X        65536        /* darunter zhlt prime_pi die Primzahlen direkt */
+#define PI_TINY_PRIMES  6            /* phi(v, 6) steht in einer Tabelle (30030 Werte) */
+#define PI_COUNTER_BITS 1024         /* Bits des Siebs von prime_pi je Zhler */
+#define PI_MAX_SEGMENT_BITS (1U << 23)  /* grtes Segment von prime_pi */
+#define PI_ROUNDS       32           /* Teilbereiche von prime_pi je Thread (je ein Fortschritt) */
+#define PI_WINDOW_BITS  32768        /* ungerade Zahlen je Fenster der Primzahlen von P2 */
+
+/* Reste modulo 30 der Bits im Rad-Sieb und umgekehrt (0xff: kein Bit) */
+static const uint32 wheel[8] = { 1, 7, 11, 13, 17, 19, 23, 29 };
+static const uint8 wheel_bit[30] = {
+  0xff,    0, 0xff, 0xff, 0xff, 0xff, 0xff,    1, 0xff, 0xff,
+  0xff,    2, 0xff,    3, 0xff, 0xff, 0xff,    4, 0xff,    5,
+  0xff, 0xff, 0xff,    6, 0xff, 0xff, 0xff, 0xff, 0xff,    7
+};
+
+/* Index des kleinsten Rests in wheel, der >= x ist (fr x = 0..29) */
+static const uint8 wheel_next[30] = {
+  0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7
+};
+
+/* Abstand von wheel[k] zum nchsten Rest (wheel[8] = 31) */
+static const uint32 wheel_gap[8] = { 6, 4, 2, 4, 2, 4, 6, 2 };
+
+/* bertrag r * wheel[k + 1] / 30 - r * wheel[k] / 30 fr die Bits r = p % 30 */
+static const uint32 wheel_carry[8][8] = {
+  { 0, 0, 0, 0, 0, 0, 0, 1 },
+  { 1, 1, 1, 0, 1, 1, 1, 1 },
+  { 2, 2, 0, 2, 0, 2, 2, 1 },
+  { 3, 1, 1, 2, 1, 1, 3, 1 },
+  { 3, 3, 1, 2, 1, 3, 3, 1 },
+  { 4, 2, 2, 2, 2, 2, 4, 1 },
+  { 5, 3, 1, 4, 1, 3, 5, 1 },
+  { 6, 4, 2, 4, 2, 4, 6, 1 }
+};
+
+/* Maske zum Streichen von p * q mit p % 30 = wheel[r] und q % 30 = wheel[k] */
+static const uint8 wheel_mask[8][8] = {
+  { 0xfe, 0xfd, 0xfb, 0xf7, 0xef, 0xdf, 0xbf, 0x7f },
+  { 0xfd, 0xdf, 0xef, 0xfe, 0x7f, 0xf7, 0xfb, 0xbf },
+  { 0xfb, 0xef, 0xfe, 0xbf, 0xfd, 0x7f, 0xf7, 0xdf },
+  { 0xf7, 0xfe, 0xbf, 0xdf, 0xfb, 0xfd, 0x7f, 0xef },
+  { 0xef, 0x7f, 0xfd, 0xfb, 0xdf, 0xbf, 0xfe, 0xf7 },
+  { 0xdf, 0xf7, 0x7f, 0xfd, 0xbf, 0xfe, 0xef, 0xfb },
+  { 0xbf, 0xfb, 0xf7, 0x7f, 0xfe, 0xef, 0xdf, 0xfd },
+  { 0x7f, 0xbf, 0xdf, 0xef, 0xf7, 0xfb, 0xfd, 0xfe }
+};
+
+/* Primzahlen der Vorsieb-Muster (je mit 0 beendet) */
+static const uint32 presieve_primes[PRESIEVE_PATTERNS][5] = {
+  { 7, 11, 13, 17, 0 },
+  { 19, 23, 29, 0 }
+};
+
+/* Primzahlen fr die Probedivision und das Fenster in sieve_local */
+static const uint8 local_primes[] = {
+    7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,  59,  61,  67,
+   71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149,
+  151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233,
+  239, 241, 251
+};
+#define TRIAL_PRIMES 13              /* local_primes bis 53 */
+
+/* pi(k * PI_TABLE_STRIDE) fr k = 0..PI_TABLE_SIZE - 1 (eingebaute Checkpoints,
+   einmal mit nth-prime --count ber die einzelnen Abschnitte berechnet) */
+static const uint64 pi_table[PI_TABLE_SIZE] = {
+            0,     3724578,     7154632,    10489480,    13765173,    16998286,
+     20197903,    23370746,    26521021,    29651393,    32765141,    35863035,
+     38946355,    42018788,    45078152,    48127369,    51167426,    54198259,
+     57220318,    60233429,    63239295,    66238728,    69231145,    72216760,
+     75197314,    78170478,    81139319,    84101734,    87059400,    90012264,
+     92959275,    95902714,    98842358,   101776697,   104706542,   107633544,
+    110556250,   113475852,   116390332,   119301586,   122209847,   125115892,
+    128017078,   130915456,   133809673,   136702683,   139591930,   142478047,
+    145361105,   148242512,   151119807,   153996136,   156868010,   159738961,
+    162606234,   165472081,   168335991,   171197254,   174056072,   176912037,
+    179767149,   182619155,   185468411,   188316386,   191161159,   194004134,
+    196846840,   199686110,   202524020,   205360452,   208194577,   211026566,
+    213857095,   216685776,   219512460,   222338652,   225161855,   227983838,
+    230804485,   233622748,   236440180,   239255029,   242069112,   244881579,
+    247692919,   250501532,   253309016,   256116231,   258920070,   261724946,
+    264527645,   267329117,   270128032,   272925992,   275722419,   278517879,
+    281312080,   284105029,   286897592,   289688284,   292477437,   295264595,
+    298050544,   300834957,   303620303,   306404071,   309185627,   311966626,
+    314746735,   317524026,   320301120,   323076942,   325852200,   328626859,
+    331399577,   334170319,   336940896,   339710809,   342479908,   345247296,
+    348013669,   350777762,   353542520,   356305629,   359068248,   361830757,
+    364591128,   367351682,   370110663,   372868712,   375624719,   378381985,
+    381137814,   383892131,   386644992,   389396632,   392148949,   394899027,
+    397647863,   400397156,   403144517,   405891892,   408637631,   411382882,
+    414127561,   416871555,   419612897,   422355495,   425097969,   427837345,
+    430577946,   433316092,   436053983,   438791938,   441529438,   444265740,
+    447000719,   449734604,   452468183,   455200781,   457932094,   460663452,
+    463393457,   466122726,   468852519,   471579597,   474307279,   477033121,
+    479758729,   482485080,   485209713,   487934035,   490658534,   493379556,
+    496102111,   498823058,   501542902,   504263897,   506983807,   509701188,
+    512418362,   515135437,   517851377,   520567996,   523285115,   525999587,
+    528715395,   531428095,   534140493,   536853021,   539563628,   542273849,
+    544984960,   547695648,   550404067,   553113388,   555820812,   558527820,
+    561235906,   563942562,   566647992,   569352050,   572056374,   574761122,
+    577463469,   580167067,   582869907,   585571147,   588272130,   590972070,
+    593672603,   596372087,   599070699,   601769572,   604466985,   607164032,
+    609860431,   612557429,   615252592,   617948312,   620642626,   623335691,
+    626029557,   628721200,   631412907,   634105252,   636796832,   639488109,
+    642179223,   644868491,   647558637,   650247194,   652935823,   655624400,
+    658311240,   660998983,   663685727,   666370860,   669057394,   671741241,
+    674426328,   677111851,   679795625,   682478144,   685160184,   687842379,
+    690523779,   693205636,   695886799,   698567391,   701247995,   703926545,
+    706605517,   709283411,   711962148,   714638803,   717315988,   719992942,
+    722668868,   725344741,   728019884,   730694379,   733368415,   736042808,
+    738716701,   741390469,   744063070,   746736248,   749408379,   752080368,
+    754751288,   757421696,   760091796,   762760698,   765430475,   768099385,
+    770768116,   773435022,   776103076,   778770610,   781437841,   784103296,
+    786770396,   789435161,   792101045,   794766546,   797430776,   800095025,
+    802758347,   805421119,   808083783,   810746071,   813408298,   816069975,
+    818732209,   821392396,   824052641,   826713105,   829374057,   832031663,
+    834691137,   837349104,   840008460,   842667039,   845324899,   847982812,
+    850640686,   853297114,   855953330,   858609796,   861265183,   863919440,
+    866573549,   869228816,   871882365,   874535642,   877188692,   879842243,
+    882494557,   885146639,   887798083,   890450344,   893102147,   895752273,
+    898403512,   901053784,   903703438,   906353548,   909002890,   911651698,
+    914300095,   916948536,   919596701,   922244222,   924890797,   927538637,
+    930185548,   932830864,   935476863,   938122449,   940767390,   943412169,
+    946056936,   948701631,   951346348,   953990265,   956633268,   959274775,
+    961917708,   964559691,   967202229,   969843331,   972484974,   975126638,
+    977767254,   980405264,   983046144,   985686088,   988326002,   990965339,
+    993605059,   996243106,   998881085,  1001518466,  1004155990,  1006793086,
+   1009429935,  1012066676,  1014701775,  1017338163,  1019973897,  1022608817,
+   1025243845,  1027879403,  1030514932,  1033149400,  1035784284,  1038418214,
+   1041050131,  1043683517,  1046316870,  1048948748,  1051582442,  1054214816,
+   1056846966,  1059477295,  1062108014,  1064739182,  1067368807,  1069998075,
+   1072629232,  1075257847,  1077887689,  1080516493,  1083144806,  1085773158,
+   1088401741,  1091029869,  1093658080,  1096285011,  1098911701,  1101539706,
+   1104165184,  1106791284,  1109416529,  1112042708,  1114668265,  1117294557,
+   1119917811,  1122541834,  1125166817,  1127791241,  1130414903,  1133038704,
+   1135661522,  1138285505,  1140907863,  1143530755,  1146154072,  1148776127,
+   1151398381,  1154019769,  1156641757,  1159262817,  1161883882,  1164504414,
+   1167124671,  1169743140,  1172363273,  1174983381,  1177602827,  1180222447,
+   1182841173,  1185459693,  1188079040,  1190695156,  1193313621,  1195931545,
+   1198549728,  1201166416,  1203783451,  1206400213,  1209015840,  1211630725,
+   1214247185,  1216862240,  1219478747,  1222093622,  1224707825,  1227321199,
+   1229934641,  1232548880,  1235161719,  1237776340,  1240389653,  1243003369,
+   1245615871,  1248229284,  1250841755,  1253453544,  1256066012,  1258678245,
+   1261288798,  1263900646,  1266510503,  1269120780,  1271731443,  1274342088,
+   1276951847,  1279561521,  1282170866,  1284778813,  1287388566,  1289997959,
+   1292607439,  1295215654,  1297823641,  1300430927,  1303038688,  1305646062,
+   1308254829,  1310862030,  1313469265,  1316075303,  1318681415,  1321287275,
+   1323893617,  1326499642,  1329106352,  1331711457,  1334317113,  1336921407,
+   1339526854,  1342129492,  1344733245,  1347336843,  1349941355,  1352545253,
+   1355148420,  1357751935,  1360355372,  1362957172,  1365559052,  1368161566,
+   1370763318,  1373364995,  1375966854,  1378568728,  1381170106,  1383771439,
+   1386372656,  1388972785,  1391572698,  1394173710,  1396773688,  1399372649,
+   1401973137,  1404572334,  1407171268,  1409769326,  1412367224,  1414966731,
+   1417565347,  1420164038,  1422762575,  1425360344,  1427957944,  1430554439,
+   1433152305,  1435747764,  1438343581,  1440940383,  1443537022,  1446131580,
+   1448727533,  1451322766,  1453917145,  1456511475,  1459107217,  1461702067,
+   1464296946,  1466890888,  1469484749,  1472079841,  1474673341,  1477266914,
+   1479859937,  1482454112,  1485047787,  1487640765,  1490233493,  1492825779,
+   1495418269,  1498010489,  1500601514,  1503194201,  1505785368,  1508376991,
+   1510966462,  1513558156,  1516149980,  1518740042,  1521331219,  1523921355,
+   1526511373,  1529101990,  1531691032,  1534280323,  1536870699,  1539459863,
+   1542048548,  1544637369,  1547226302,  1549816423,  1552403933,  1554992260,
+   1557580618,  1560167412,  1562754032,  1565339744,  1567926982,  1570515079,
+   1573101823,  1575689576,  1578275230,  1580860352,  1583445955,  1586031849,
+   1588616737,  1591202181,  1593787613,  1596372258,  1598957716,  1601542055,
+   1604126897,  1606710243,  1609294763,  1611877972,  1614462225,  1617046176,
+   1619629805,  1622211972,  1624795459,  1627378881,  1629962161,  1632545182,
+   1635127840,  1637710872,  1640293122,  1642872795,  1645454331,  1648035838,
+   1650617387,  1653198211,  1655779109,  1658359540,  1660940027,  1663519627,
+   1666098302,  1668679308,  1671260487,  1673840347,  1676418147,  1678997236,
+   1681576739,  1684155557,  1686734557,  1689314314,  1691890806,  1694468338,
+   1697048338,  1699625326,  1702204753,  1704782398,  1707359985,  1709937274,
+   1712514411,  1715090536,  1717666816,  1720243133,  1722820937,  1725397736,
+   1727973792,  1730549770,  1733126805,  1735703155,  1738278226,  1740853205,
+   1743428995,  1746004546,  1748578733,  1751153707,  1753728388,  1756300956,
+   1758873939,  1761447541,  1764022651,  1766596268,  1769169517,  1771743584,
+   1774317234,  1776891100,  1779463948,  1782035615,  1784609938,  1787181834,
+   1789754410,  1792326499,  1794899392,  1797471529,  1800044438,  1802615562,
+   1805187130,  1807758038,  1810330294,  1812901117,  1815472504,  1818043207,
+   1820612699,  1823183110,  1825751428,  1828321131,  1830891588,  1833459784,
+   1836028984,  1838599134,  1841167391,  1843736120,  1846305406,  1848873747,
+   1851442829,  1854011169,  1856579977,  1859147752,  1861716061,  1864284598,
+   1866852522,  1869420969,  1871988086,  1874555499,  1877122059,  1879689619,
+   1882255987,  1884823674,  1887390192,  1889955535,  1892521455,  1895088242,
+   1897654845,  1900220123,  1902785989,  1905351304,  1907917417,  1910483027,
+   1913047724,  1915613456,  1918178336,  1920743834,  1923307688,  1925871520,
+   1928436203,  1930999866,  1933563442,  1936126107,  1938690027,  1941253801,
+   1943817538,  1946381282,  1948944769,  1951507216,  1954070788,  1956633103,
+   1959194816,  1961756575,  1964318402,  1966879973,  1969441497,  1972002311,
+   1974564605,  1977126526,  1979688714,  1982249794,  1984810653,  1987370563,
+   1989932403,  1992493185,  1995053744,  1997614506,  2000173006,  2002732455,
+   2005291997,  2007851392,  2010412364,  2012972116,  2015531434,  2018089385,
+   2020649325,  2023207926,  2025766458,  2028324414,  2030882765,  2033441492,
+   2036000556,  2038558773,  2041116498,  2043673853,  2046231277,  2048788589,
+   2051346000,  2053901986,  2056459284,  2059017199,  2061573838,  2064130087,
+   2066687317,  2069243818,  2071799599,  2074356636,  2076913208,  2079469466,
+   2082025190,  2084580376,  2087137229,  2089692893,  2092247518,  2094803670,
+   2097357722,  2099912483,  2102468382,  2105021828,  2107575382,  2110129552,
+   2112682978,  2115238037,  2117793018,  2120347447,  2122899153,  2125452053,
+   2128004902,  2130558420,  2133113576,  2135666931,  2138219612,  2140772635,
+   2143325540,  2145878617,  2148431662,  2150983649,  2153536535,  2156087958,
+   2158639954,  2161192757,  2163745187,  2166296167,  2168848060,  2171399800,
+   2173950187,  2176500516,  2179050638,  2181602264,  2184152891,  2186705339,
+   2189255581,  2191806293,  2194356662,  2196906541,  2199456302,  2202006864,
+   2204555271,  2207103669,  2209652736,  2212201044,  2214750511,  2217300288,
+   2219848216,  2222398754,  2224948177,  2227496037,  2230045410,  2232593984,
+   2235140798,  2237688751,  2240236255,  2242785215,  2245333170,  2247881189,
+   2250428393,  2252977130,  2255524571,  2258071587,  2260619261,  2263166061,
+   2265711756,  2268258591,  2270805904,  2273350678,  2275897849,  2278443403,
+   2280989413,  2283534431,  2286080429,  2288625383,  2291171031,  2293716355,
+   2296263056,  2298809673,  2301353022,  2303897475,  2306441213,  2308986673,
+   2311531213,  2314076734,  2316620846,  2319165071,  2321710669,  2324254978,
+   2326798686,  2329341262,  2331884431,  2334427847,  2336970998,  2339514432,
+   2342057598,  2344601047,  2347143976,  2349686333,  2352229852,  2354771501,
+   2357313956,  2359857099,  2362398696,  2364941027,  2367482465,  2370025246,
+   2372567003,  2375107754,  2377649968,  2380192227,  2382733554,  2385273383,
+   2387813459,  2390355627,  2392896513,  2395437565,  2397977460,  2400517237,
+   2403058632,  2405598757,  2408137689,  2410678793,  2413219380,  2415760011,
+   2418296912,  2420836872,  2423376625,  2425915871,  2428456319,  2430995841,
+   2433534133,  2436073024,  2438610772,  2441149853,  2443687989,  2446226761,
+   2448765972,  2451303662,  2453841646,  2456380257,  2458917875,  2461454770,
+   2463990740,  2466527375,  2469064873,  2471603287,  2474140685,  2476678070,
+   2479213948,  2481751118,  2484288694,  2486824860,  2489362128,  2491899134,
+   2494435061,  2496971655,  2499507764,  2502043894,  2504580002,  2507116607,
+   2509651267,  2512186675,  2514722194,  2517256931,  2519791504,  2522327940,
+   2524863287,  2527398504,  2529934046,  2532468807,  2535003799,  2537538563,
+   2540073711,  2542607493,  2545142500,  2547676996,  2550210216,  2552743933,
+   2555278067,  2557812070,  2560345857,  2562877861,  2565411622,  2567944735,
+   2570477504,  2573011221,  2575543985,  2578076273,  2580607898,  2583140739,
+   2585673075,  2588205722,  2590737053,  2593269526,  2595801248,  2598333662,
+   2600864894,  2603398171,  2605929613,  2608461099,  2610991518,  2613524002,
+   2616056449,  2618587186,  2621117694,  2623648476,  2626177598,  2628708859,
+   2631239716,  2633771252,  2636301887,  2638831987,  2641361664,  2643893409,
+   2646424180,  2648953220,  2651482919,  2654012452,  2656541484,  2659070886,
+   2661600230,  2664130162,  2666659304,  2669189508,  2671718501,  2674247253,
+   2676777111,  2679305510,  2681833184,  2684361907,  2686890778,  2689420029,
+   2691948414,  2694476399,  2697004360,  2699532089,  2702060228,  2704587586,
+   2707113718,  2709641145,  2712168473,  2714695961,  2717223232,  2719750308,
+   2722277503,  2724804784,  2727331671,  2729858475,  2732386234,  2734913046,
+   2737438869,  2739965847,  2742493841,  2745018884,  2747544154,  2750069349,
+   2752595721,  2755121452,  2757645877,  2760172145,  2762697150,  2765222342,
+   2767746839,  2770272420,  2772798590,  2775324871,  2777848986,  2780374576,
+   2782898374,  2785422506,  2787947978,  2790472182,  2792995741,  2795520206,
+   2798044144,  2800567923,  2803091493,  2805615379,  2808138858,  2810663263,
+   2813186608,  2815710142,  2818232844,  2820756208,  2823279030,  2825802929,
+   2828326867,  2830849678,  2833373100,  2835895786,  2838418539,  2840939923,
+   2843463797,  2845984693,  2848506848,  2851028210,  2853550090,  2856073463,
+   2858596069,  2861118318,  2863640124,  2866161001,  2868683640,  2871205005,
+   2873726975,  2876247983,  2878769132,  2881290307,  2883811390,  2886333538,
+   2888854604,  2891375075,  2893895632,  2896416054,  2898936764,  2901457518,
+   2903976852,  2906497430,  2909017242,  2911539057,  2914058937,  2916578830,
+   2919098069,  2921617976,  2924136950,  2926656476,  2929175287,  2931694709,
+   2934213037,  2936731364,  2939250032,  2941769175,  2944288148,  2946807446,
+   2949325380,  2951843862,  2954362238,  2956880627,  2959399004,  2961915634,
+   2964434175,  2966953877,  2969472170,  2971991979,  2974509145,  2977026715,
+   2979546083,  2982064318,  2984582385,  2987097898,  2989614434,  2992130113,
+   2994648173,  2997163949,  2999679398,  3002196063,  3004711666,  3007227362,
+   3009743491,  3012260691,  3014776658,  3017293152,  3019810746,  3022325813,
+   3024840757,  3027357833,  3029874213,  3032389432,  3034905007,  3037420576,
+   3039935832,  3042451003,  3044966839,  3047481845,  3049997426,  3052513049,
+   3055028721,  3057543352,  3060057839,  3062573104,  3065087174,  3067601116,
+   3070115406,  3072629072,  3075143629,  3077657296,  3080171249,  3082683414,
+   3085196169,  3087710173,  3090224813,  3092737442,  3095251171,  3097765845,
+   3100278765,  3102792516,  3105306478,  3107819757,  3110332063,  3112845372,
+   3115357820,  3117870467,  3120383017,  3122896198,  3125408217,  3127921237,
+   3130433691,  3132945662,  3135457966,  3137970070,  3140482533,  3142994363,
+   3145506745,  3148018637,  3150531304,  3153042902,  3155554413,  3158064034,
+   3160575648,  3163087551,  3165599468,  3168109724,  3170621550,  3173132060,
+   3175642719,  3178153879,  3180664958,  3183175887,  3185687884,  3188198959,
+   3190710064,  3193220497,  3195730833,  3198239324,  3200751092,  3203260395,
+   3205770477,  3208279828,  3210790434,  3213300259,  3215810800,  3218319148,
+   3220828859,  3223337879,  3225847604,  3228355821,  3230865222,  3233374010,
+   3235881619,  3238389587,  3240897968,  3243405918,  3245914568,  3248422809,
+   3250931073,  3253438886,  3255948036,  3258455472,  3260965166,  3263472978,
+   3265980520,  3268488816,  3270996658,  3273505426,  3276012104,  3278519975,
+   3281027301,  3283535297,  3286043509,  3288551590,  3291058665,  3293564736,
+   3296071064,  3298578087,  3301085407,  3303591771,  3306097991,  3308603985,
+   3311110780,  3313616539,  3316122871,  3318630079,  3321135989,  3323640738,
+   3326148285,  3328653373,  3331158754,  3333663900,  3336170705,  3338676179,
+   3341181903,  3343688065,  3346193285,  3348698040,  3351204028,  3353709155,
+   3356213583,  3358717308,  3361222577,  3363727385,  3366232307,  3368736943,
+   3371242924,  3373746676,  3376251571,  3378755148,  3381259570,  3383764648,
+   3386267949,  3388771377,  3391275232,  3393780486,  3396284202,  3398787644,
+   3401290205,  3403794834,  3406297005,  3408801044,  3411304469,  3413808643,
+   3416312300,  3418815789,  3421318555,  3423821366,  3426325221,  3428827828,
+   3431330823,  3433832397,  3436336345,  3438838572,  3441340233,  3443842983,
+   3446345629,  3448847488,  3451348677,  3453850496,  3456353383,  3458856442,
+   3461358792,  3463861106,  3466364182,  3468864963,  3471366557,  3473868361,
+   3476367514,  3478870325,  3481372402,  3483872855,  3486374108,  3488874918,
+   3491374790,  3493875112,  3496375339,  3498876102,  3501377748,  3503878808,
+   3506380398,  3508881448,  3511380862,  3513881017,  3516382248,  3518881679,
+   3521382590,  3523882208,  3526382467,  3528881346,  3531381714,  3533882178,
+   3536382073,  3538881641,  3541381047,  3543878742,  3546377251,  3548876335,
+   3551377013,  3553877049,  3556375806,  3558874667,  3561373828,  3563873678,
+   3566372343,  3568870117,  3571368618,  3573865683,  3576363959,  3578861423,
+   3581359524,  3583858404,  3586355954,  3588853896,  3591351382,  3593849890,
+   3596348877,  3598846142,  3601344626,  3603842227,  3606340917,  3608838649,
+   3611336871,  3613834126,  3616331490,  3618829441,  3621325375,  3623822225,
+   3626319028,  3628816129,  3631315057,  3633811068,  3636306780,  3638802830,
+   3641298551,  3643795442,  3646292676,  3648786847,  3651284511,  3653780452,
+   3656277722,  3658774098,  3661270099,  3663766103,  3666262226,  3668758642,
+   3671254747,  3673750294,  3676245726,  3678741182,  3681236105,  3683731993,
+   3686228536,  3688723443,  3691218386,  3693712869,  3696207733,  3698703800,
+   3701199772,  3703695229,  3706189329,  3708683602,  3711177503,  3713672774,
+   3716165787,  3718660007,  3721153141,  3723648013,  3726142333,  3728635800,
+   3731129705,  3733624391,  3736118969,  3738613223,  3741106618,  3743601205,
+   3746094482,  3748588772,  3751081943,  3753574901,  3756069048,  3758562721,
+   3761054881,  3763547636,  3766041818,  3768533614,  3771027090,  3773520888,
+   3776013728,  3778506446,  3781000228,  3783492037,  3785984450,  3788476949,
+   3790970350,  3793463063,  3795954892,  3798446823,  3800938956,  3803431385,
+   3805923308,  3808416952,  3810908356,  3813399677,  3815892418,  3818385465,
+   3820875935,  3823367412,  3825858781,  3828350408,  3830840178,  3833330890,
+   3835821340,  3838312975,  3840805583,  3843296569,  3845786826,  3848278251,
+   3850768997,  3853260194,  3855751725,  3858242539,  3860733427,  3863223359,
+   3865714914,  3868205192,  3870695544,  3873187222,  3875677911,  3878166630,
+   3880657453,  3883147846,  3885638779,  3888127734,  3890617759,  3893107291,
+   3895596276,  3898085783,  3900574806,  3903064126,  3905553600,  3908043674,
+   3910531641,  3913020961,  3915509511,  3917998720,  3920488809,  3922977910,
+   3925467390,  3927955707,  3930443741,  3932930979,  3935419441,  3937908397,
+   3940397468,  3942886471,  3945374467,  3947863416,  3950351186,  3952839415,
+   3955327701,  3957816035,  3960304780,  3962792335,  3965280933,  3967768034,
+   3970255195,  3972743166,  3975229498,  3977717004,  3980205229,  3982692139,
+   3985179240,  3987665048,  3990152040,  3992639655,  3995126602,  3997614398,
+   4000101359,  4002588002,  4005075650,  4007562623,  4010048904,  4012535569,
+   4015022345,  4017508553,  4019994643,  4022481715,  4024968116,  4027453978,
+   4029940743,  4032426731,  4034913320,  4037400223,  4039886944,  4042373532,
+   4044859716,  4047345771,  4049831875,  4052316494,  4054801168,  4057286574,
+   4059772964,  4062258495,  4064743589,  4067227776,  4069713624,  4072198381,
+   4074682696,  4077168426,  4079652765,  4082136827,  4084620800,  4087106381,
+   4089591311,  4092077267,  4094561700,  4097045470,  4099530411,  4102014401,
+   4104497903,  4106981892,  4109465802,  4111950263,  4114434337,  4116918557,
+   4119402898,  4121887202,  4124371074,  4126854118,  4129338629,  4131821518,
+   4134305756,  4136789405,  4139273356,  4141757900,  4144242188,  4146724345,
+   4149206477,  4151689678,  4154172695,  4156656278,  4159139865,  4161623305,
+   4164107366,  4166590945,  4169073561,  4171556864,  4174039287,  4176521639,
+   4179003222,  4181485716,  4183967973,  4186450112,  4188932809,  4191415580,
+   4193896508,  4196378218,  4198860400,  4201342107,  4203825264,  4206306654,
+   4208788399,  4211271179,  4213752525,  4216234660,  4218715158,  4221197471,
+   4223678685,  4226160219,  4228640577,  4231120878,  4233602516,  4236084066,
+   4238564278,  4241044773,  4243526557,  4246007313,  4248486728,  4250967306,
+   4253447752,  4255926960,  4258408323,  4260887796,  4263367922,  4265847889,
+   4268328297,  4270807925,  4273289091,  4275768319,  4278249497,  4280727778,
+   4283209086,  4285689608,  4288168242,  4290648218,  4293129232,  4295608185,
+   4298087712,  4300567400,  4303047495,  4305527421,  4308007221,  4310485996,
+   4312965955,  4315445241,  4317923753,  4320401569,  4322880754,  4325359061,
+   4327837898,  4330316713,  4332794423,  4335272462,  4337751183,  4340229466,
+   4342707311,  4345185553,  4347664513,  4350142434,  4352620996,  4355099543,
+   4357576585,  4360053551,  4362532522,  4365009373,  4367486485,  4369963682,
+   4372442585,  4374919561,  4377397464,  4379874962,  4382351336,  4384829305,
+   4387306746,  4389783233,  4392261113,  4394737777,  4397215356,  4399692573,
+   4402169773,  4404648251,  4407125803,  4409603421,  4412079100,  4414555647,
+   4417032828,  4419510518,  4421986259,  4424461931,  4426938358,  4429414823,
+   4431891092,  4434368020,  4436844854,  4439321307,  4441797282,  4444273195,
+   4446749794,  4449225025,  4451700142,  4454176663,  4456652459,  4459127874,
+   4461603501,  4464078497,  4466553888,  4469029817,  4471505686,  4473982725,
+   4476458669,  4478933130,  4481407693,  4483882551,  4486358486,  4488834155,
+   4491309864,  4493783738,  4496259325,  4498734233,  4501209123,  4503683005,
+   4506156983,  4508631422,  4511107319,  4513582256,  4516056364,  4518530760,
+   4521004760,  4523479252,  4525954027,  4528428702,  4530901752,  4533377299,
+   4535852214,  4538324796,  4540799475,  4543273240,  4545746886,  4548221426,
+   4550696006,  4553168675,  4555642740,  4558117340,  4560590757,  4563064923,
+   4565538735,  4568010987,  4570484447,  4572958675,  4575432166,  4577906241,
+   4580378699,  4582852200,  4585324471,  4587797927,  4590272095,  4592744483,
+   4595216969,  4597688952,  4600162888,  4602634490,  4605106565,  4607577809,
+   4610050257,  4612523821,  4614997163,  4617469268,  4619942224,  4622414143,
+   4624885539,  4627358252,  4629832065,  4632303165,  4634775561,  4637246689,
+   4639719005,  4642191532,  4644662085,  4647133265,  4649605444,  4652076187,
+   4654548465,  4657019244,  4659490845,  4661961648,  4664433379,  4666906116,
+   4669378097,  4671849008,  4674319364,  4676791089,  4679262236,  4681733240,
+   4684203188,  4686675278,  4689146663,  4691618059,  4694088748,  4696560159,
+   4699030631,  4701502954,  4703972701,  4706442581,  4708911663,  4711382784,
+   4713852980,  4716322515,  4718792025,  4721262529,  4723733559,  4726202833,
+   4728672222,  4731141851,  4733611742,  4736082558,  4738553359,  4741023060,
+   4743492420,  4745962194,  4748430341,  4750899866,  4753369468,  4755839082,
+   4758307362,  4760775907,  4763245678,  4765714723,  4768182549,  4770651931,
+   4773121106,  4775589551,  4778059080,  4780527793,  4782996740,  4785466189,
+   4787934657,  4790403326,  4792872336,  4795340901,  4797809398,  4800278565,
+   4802745524,  4805213436,  4807682992,  4810151543,  4812618262,  4815085320,
+   4817553926,  4820022602,  4822490487,  4824960042,  4827426903,  4829893982,
+   4832361102,  4834829479,  4837296295,  4839762985,  4842230602,  4844699436,
+   4847166376,  4849634337,  4852101409,  4854567769,  4857034289,  4859500431,
+   4861966588,  4864434307,  4866901488,  4869368805,  4871837240,  4874303911,
+   4876771047,  4879237658,  4881703797,  4884170504,  4886637341,  4889106119,
+   4891570782,  4894036746,  4896502436,  4898967921,  4901432613,  4903899621,
+   4906365465,  4908833205,  4911298390,  4913765367,  4916228971,  4918695367,
+   4921159331,  4923625723,  4926090847,  4928557090,  4931022204,  4933489165,
+   4935954793,  4938421009,  4940885810,  4943350370,  4945815568,  4948281522,
+   4950746577,  4953212762,  4955677666,  4958142649,  4960609053,  4963074421,
+   4965539154,  4968005079,  4970470021,  4972936210,  4975402322,  4977866493,
+   4980332042,  4982797529,  4985262561,  4987726170,  4990191248,  4992656179,
+   4995120451,  4997584753,  5000047904,  5002512856,  5004976085,  5007439514,
+   5009904703,  5012367983,  5014831188,  5017295325,  5019760344,  5022224078,
+   5024686789,  5027151571,  5029614792,  5032079158,  5034544391,  5037008445,
+   5039471902,  5041935769,  5044399224,  5046862774,  5049326921,  5051789385,
+   5054252678,  5056716013,  5059178852,  5061642868,  5064105173,  5066567961,
+   5069030243,  5071493866,  5073956710,  5076420169,  5078882155,  5081344423,
+   5083807877,  5086270857,  5088733117,  5091194954,  5093658151,  5096119112,
+   5098582329,  5101045182,  5103507754,  5105970048,  5108432880,  5110894678,
+   5113354886,  5115816557,  5118277248,  5120740055,  5123201906,  5125662762,
+   5128124549,  5130586191,  5133047470,  5135508315,  5137969064,  5140430710,
+   5142892059,  5145353598,  5147814683,  5150276844,  5152737562,  5155198490,
+   5157660259,  5160120717,  5162582274,  5165042851,  5167503648,  5169964994,
+   5172425119,  5174885111,  5177346380,  5179808435,  5182270190,  5184730867,
+   5187190750,  5189651307,  5192111586,  5194570937,  5197031853,  5199491442,
+   5201951765,  5204412695,  5206872903,  5209334481,  5211794449,  5214254504,
+   5216714104,  5219174125,  5221635245,  5224094004,  5226554085,  5229012775,
+   5231473967,  5233934240,  5236393010,  5238852064,  5241312175,  5243770873,
+   5246228881,  5248690500,  5251149245,  5253608245,  5256067186,  5258527762,
+   5260988272,  5263449518,  5265907563,  5268366426,  5270825995,  5273284857,
+   5275744203,  5278202756,  5280660988,  5283120752,  5285579772,  5288038249,
+   5290497904,  5292955213,  5295414176,  5297873584,  5300331835,  5302790496,
+   5305248244,  5307705732,  5310163475,  5312622854,  5315081529,  5317538688,
+   5319997122,  5322455006,  5324913177,  5327370448,  5329828570,  5332285919,
+   5334744483,  5337202675,  5339660489,  5342117004,  5344573565,  5347031591,
+   5349489755,  5351946533,  5354404909,  5356860247,  5359318647,  5361776049,
+   5364233109,  5366690140,  5369146918,  5371603257,  5374060134,  5376516926,
+   5378973897,  5381430935,  5383888665,  5386346120,  5388802344,  5391258212,
+   5393714061,  5396170437,  5398627398,  5401083448,  5403540304,  5405996811,
+   5408453328,  5410909603,  5413366225,  5415823437,  5418278769,  5420736537,
+   5423192289,  5425647299,  5428104092,  5430558449,  5433014922,  5435470681,
+   5437927181,  5440384581,  5442841151,  5445296949,  5447752032,  5450208397,
+   5452663761,  5455119023,  5457573554,  5460029247,  5462484425,  5464938736,
+   5467393599,  5469849199,  5472304926,  5474760237,  5477216540,  5479670078,
+   5482124585,  5484577945,  5487034127,  5489488994,  5491944313,  5494397849,
+   5496852960,  5499307189,  5501762084,  5504216714,  5506670123,  5509125159,
+   5511579022,  5514032809,  5516488155,  5518942861,  5521396799,  5523851078,
+   5526303708,  5528758349,  5531212395,  5533666803,  5536120548,  5538574604,
+   5541028845,  5543483978,  5545938945,  5548391825,  5550846031,  5553299930,
+   5555753822,  5558206247,  5560659610,  5563114212,  5565568790,  5568022929,
+   5570476670,  5572928939,  5575382357,  5577835670,  5580288397,  5582741797,
+   5585194230,  5587647755,  5590100498,  5592553338,  5595006150,  5597458105,
+   5599910651,  5602363835,  5604816338,  5607267712,  5609721491,  5612174051,
+   5614626412,  5617078091,  5619531887,  5621983786,  5624438296,  5626890660,
+   5629343586,  5631797144,  5634248784,  5636700432,  5639152964,  5641606752,
+   5644058705,  5646511843,  5648964084,  5651417738,  5653868352,  5656321141,
+   5658773004,  5661224845,  5663675572,  5666126599,  5668578432,  5671030394,
+   5673481711,  5675932210,  5678383369,  5680834720,  5683287186,  5685738084,
+   5688190263,  5690642265,  5693091892,  5695543503,  5697994206,  5700445181,
+   5702895399,  5705346328,  5707797622,  5710248631,  5712699665,  5715149697,
+   5717600406,  5720050357,  5722501986,  5724953437,  5727404445,  5729854493,
+   5732306161,  5734756193,  5737206722,  5739657756,  5742108333,  5744558422,
+   5747008905,  5749458796,  5751909739,  5754359685,  5756808734,  5759259306,
+   5761709247,  5764159416,  5766609831,  5769058861,  5771508651,  5773959305,
+   5776409946,  5778859453,  5781309591,  5783759494,  5786209198,  5788657631,
+   5791106450,  5793555719,  5796004623,  5798453507,  5800902862,  5803352623,
+   5805802687,  5808252160,  5810700878,  5813150824,  5815600218,  5818047903,
+   5820497837,  5822946754,  5825397108,  5827846025,  5830295639,  5832744087,
+   5835193530,  5837642145,  5840090827,  5842540179,  5844989162,  5847439085,
+   5849887601,  5852336850,  5854783511,  5857231849,  5859680016,  5862127202,
+   5864574598,  5867023107,  5869472120,  5871920894,  5874369165,  5876816897,
+   5879265188,  5881713817,  5884161051,  5886608882,  5889056022,  5891505211,
+   5893954615,  5896401515,  5898849217,  5901297108,  5903743005,  5906191379,
+   5908639931,  5911087302,  5913534391,  5915982632,  5918430908,  5920878206,
+   5923324898,  5925771943,  5928220267,  5930667345,  5933113823,  5935562937,
+   5938010322,  5940457675,  5942903788,  5945349795,  5947797441,  5950244035,
+   5952688810,  5955136801,  5957584634,  5960032201,  5962479940,  5964925553,
+   5967372705,  5969819578,  5972266800,  5974713153,  5977159274,  5979606570,
+   5982053857,  5984500054,  5986948029,  5989393758,  5991839403,  5994286063,
+   5996731359,  5999177596,  6001625286,  6004072675,  6006516704,  6008962214,
+   6011408637,  6013854732,  6016299745,  6018745887,  6021191397,  6023636315,
+   6026081917,  6028526181,  6030972399,  6033418381,  6035864005,  6038310909,
+   6040755158,  6043200217,  6045644019,  6048089177,  6050534000,  6052979204,
+   6055424080,  6057869007,  6060314014,  6062760317,  6065204624,  6067649284,
+   6070094502,  6072538963,  6074983258,  6077428867,  6079872500,  6082317200,
+   6084762383,  6087206815,  6089651508,  6092095742,  6094539999,  6096985617,
+   6099430097,  6101874260,  6104318157,  6106761753,  6109205465,  6111649438,
+   6114093424,  6116537532,  6118981873,  6121424356,  6123870002,  6126312967,
+   6128756950,  6131200686,  6133645741,  6136088948,  6138530934,  6140974499,
+   6143418054,  6145861235,  6148305846,  6150749796,  6153193217,  6155635347,
+   6158078104,  6160521225,  6162964475,  6165408166,  6167851493,  6170295589,
+   6172738809,  6175181974,  6177625683,  6180068333,  6182511927,  6184955082,
+   6187398228,  6189841002,  6192282886,  6194724641,  6197167387,  6199609861,
+   6202051918,  6204494245,  6206935720,  6209379300,  6211820113,  6214262504,
+   6216705385,  6219147519,  6221589686,  6224033126,  6226475612,  6228918746,
+   6231361782,  6233805411,  6236247557,  6238689507,  6241131371,  6243574456,
+   6246016915,  6248459330,  6250900755,  6253343147,  6255783956,  6258225246,
+   6260666729,  6263108651,  6265550405,  6267994039,  6270437610,  6272878877,
+   6275321368,  6277762441,  6280203033,  6282645151,  6285087283,  6287529354,
+   6289971432,  6292412197,  6294854498,  6297294779,  6299735811,  6302176848,
+   6304617530,  6307058832,  6309500013,  6311941778,  6314383076,  6316823742,
+   6319264459,  6321706018,  6324147376,  6326588393,  6329031118,  6331471044,
+   6333911448,  6336353147,  6338793057,  6341233833,  6343674468,  6346114692,
+   6348554608,  6350994481,  6353435141,  6355874883,  6358314923,  6360755608,
+   6363195399,  6365636173,  6368075963,  6370515015,  6372955050,  6375394640,
+   6377835299,  6380276263,  6382716283,  6385156304,  6387595456,  6390035032,
+   6392475428,  6394914431,  6397353280,  6399793639,  6402232623,  6404673636,
+   6407112901,  6409552341,  6411990207,  6414430083,  6416870435,  6419310829,
+   6421751145,  6424189890,  6426629997,  6429068594,  6431507402,  6433947142,
+   6436385800,  6438824394,  6441263269,  6443703056,  6446141901,  6448580751,
+   6451018774,  6453458374,  6455895411,  6458334617,  6460774414,  6463213326,
+   6465652071,  6468090955,  6470529915,  6472969005,  6475408071,  6477846384,
+   6480283904,  6482722414,  6485160521,  6487599560,  6490039098,  6492478402,
+   6494916151,  6497352982,  6499790817,  6502229424,  6504668040,  6507104705,
+   6509541329,  6511978556,  6514416068,  6516854960,  6519293312,  6521731743,
+   6524168948,  6526606476,  6529043770,  6531481808,  6533918694,  6536358620,
+   6538795105,  6541232806,  6543669023,  6546106336,  6548544710,  6550981353,
+   6553417563,  6555854836,  6558292885,  6560729590,  6563167213,  6565603949,
+   6568041364,  6570477098,  6572914151,  6575352541,  6577789790,  6580227293,
+   6582662898,  6585099080,  6587537126,  6589972485,  6592409365,  6594846603,
+   6597283922,  6599720147,  6602156423,  6604592120,  6607028597,  6609465160,
+   6611901982,  6614337037,  6616773325,  6619210296,  6621647754,  6624083878,
+   6626519558,  6628955146,  6631391593,  6633827095,  6636263799,  6638700361,
+   6641137701,  6643574856,  6646010751,  6648446817,  6650882470,  6653318163,
+   6655751950,  6658188325,  6660622715,  6663056713,  6665492310,  6667927988,
+   6670364241,  6672800757,  6675235859,  6677671778,  6680105431,  6682541589,
+   6684977818,  6687413934,  6689848893,  6692283247,  6694718610,  6697153209,
+   6699587363,  6702022896,  6704458502,  6706894161,  6709329226,  6711763738,
+   6714200068,  6716634467,  6719070567,  6721505648,  6723939685,  6726375496,
+   6728808992,  6731243825,  6733679274,  6736113490,  6738547004,  6740981509,
+   6743415829,  6745850507,  6748284861,  6750720432,  6753154862,  6755588631,
+   6758023501,  6760458120,  6762892059,  6765326115,  6767759775,  6770194772,
+   6772628358,  6775063121,  6777497679,  6779931978,  6782367068,  6784801815,
+   6787235821,  6789669540,  6792102945,  6794535236,  6796968675,  6799403024,
+   6801836818,  6804270636,  6806705426,  6809137941,  6811572107,  6814005066,
+   6816437928,  6818870660,  6821304789,  6823738744,  6826171702,  6828605385,
+   6831039960,  6833473178,  6835906502,  6838339660,  6840771815,  6843203562,
+   6845637322,  6848069936,  6850502823,  6852935414,  6855368489,  6857801475,
+   6860234247,  6862667382,  6865100858,  6867534765,  6869968459,  6872401497,
+   6874833146,  6877264489,  6879697374,  6882131332,  6884564089,  6886997907,
+   6889430270,  6891864939,  6894296829,  6896729181,  6899162000,  6901594408,
+   6904025178,  6906456009,  6908888669,  6911320355,  6913752855,  6916185615,
+   6918616055,  6921047557,  6923480437,  6925912934,  6928343428,  6930775338,
+   6933207407,  6935639692,  6938070718,  6940502541,  6942933715,  6945366466,
+   6947797426,  6950229545,  6952661108,  6955091726,  6957522818,  6959953812,
+   6962385799,  6964816642,  6967248099,  6969679171,  6972110036,  6974541906,
+   6976973610,  6979406169,  6981837362,  6984267769,  6986698475,  6989129377,
+   6991560568,  6993991476,  6996422989,  6998853680,  7001283503,  7003713804,
+   7006144838,  7008575627,  7011006571,  7013437053,  7015868517,  7018299404,
+   7020729669,  7023160724,  7025591426,  7028023089,  7030452720,  7032882838,
+   7035311914,  7037741375,  7040172445,  7042600918,  7045033064,  7047464858,
+   7049894490,  7052324595,  7054756128,  7057186039,  7059614840,  7062046738,
+   7064475979,  7066905698,  7069336260,  7071765397,  7074194764,  7076623856,
+   7079052401,  7081482165,  7083911706,  7086341125,  7088771929,  7091202278,
+   7093629032,  7096059967,  7098490883,  7100919148,  7103348966,  7105778349,
+   7108207374,  7110637385,  7113067896,  7115497273,  7117926253,  7120356180,
+   7122786285,  7125215605,  7127645494,  7130073618,  7132503723,  7134932457,
+   7137361476,  7139790061,  7142219060,  7144646641,  7147075606,  7149504052,
+   7151932953,  7154361818,  7156790273,  7159219229,  7161647148,  7164075210,
+   7166503045,  7168932388,  7171360863,  7173789217,  7176218922,  7178647624,
+   7181076440,  7183504553,  7185930439,  7188358944,  7190786331,  7193215671,
+   7195642417,  7198070813,  7200499636,  7202928148,  7205357947,  7207786602,
+   7210213220,  7212641395,  7215069305,  7217498288,  7219925633,  7222353872,
+   7224782071,  7227208872,  7229637693,  7232066803,  7234495167,  7236922399,
+   7239349327,  7241777141,  7244204703,  7246630328,  7249058393,  7251485646,
+   7253913589,  7256340491,  7258767517,  7261194190,  7263621339,  7266047626,
+   7268474826,  7270901509,  7273328702,  7275756349,  7278181991,  7280609288,
+   7283036866,  7285464592,  7287891694,  7290318138,  7292746443,  7295173082,
+   7297598562,  7300025544,  7302452012,  7304879564,  7307305662,  7309732650,
+   7312159165,  7314586198,  7317014066,  7319440723,  7321867334,  7324293710,
+   7326720054,  7329146011,  7331572937,  7334000674,  7336425547,  7338850648,
+   7341277165,  7343702562,  7346130005,  7348555919,  7350981585,  7353407870,
+   7355834052,  7358260216,  7360686458,  7363111986,  7365537697,  7367963353,
+   7370390172,  7372815645,  7375239868,  7377665446,  7380090873,  7382516986,
+   7384941397,  7387367085,  7389793051,  7392218445,  7394645661,  7397069303,
+   7399494610,  7401920597,  7404345732,  7406770196,  7409196310,  7411623080,
+   7414048645,  7416472979,  7418897854,  7421322758,  7423748284,  7426175180,
+   7428601691,  7431025982,  7433451131,  7435875769,  7438300155,  7440724686,
+   7443149730,  7445574635,  7447997856,  7450421538,  7452847170,  7455270724,
+   7457694887,  7460119013,  7462543734,  7464967363,  7467391479,  7469815369,
+   7472240035,  7474664572,  7477089568,  7479515067,  7481939949,  7484364221,
+   7486787302,  7489211821,  7491636364,  7494060748,  7496485009,  7498909544,
+   7501334019,  7503758069,  7506183117,  7508606760,  7511031275,  7513456110,
+   7515878952,  7518303092,  7520726671,  7523150362,  7525574647,  7527999130,
+   7530422249,  7532846058,  7535271363,  7537694638,  7540117831,  7542540882,
+   7544962756,  7547386752,  7549810142,  7552233120,  7554655865,  7557081869,
+   7559504780,  7561928989,  7564351084,  7566773424,  7569198140,  7571620790,
+   7574044422,  7576467001,  7578889789,  7581312365,  7583736488,  7586159829,
+   7588581902,  7591004844,  7593426135,  7595849685,  7598272434,  7600694975,
+   7603117530,  7605541359,  7607964415,  7610387060,  7612810067,  7615232666,
+   7617656100,  7620078187,  7622500958,  7624924007,  7627346749,  7629768793,
+   7632189584,  7634612329,  7637033941,  7639455983,  7641878661,  7644301448,
+   7646722895,  7649144312,  7651565733,  7653987689,  7656410831,  7658832271,
+   7661254828,  7663676550,  7666097860,  7668520315,  7670943811,  7673365632,
+   7675785483,  7678208368,  7680630321,  7683052525,  7685474470,  7687896293,
+   7690319107,  7692739511,  7695162187,  7697584081,  7700005769,  7702427532,
+   7704849831,  7707271193,  7709691248,  7712112551,  7714535216,  7716956952,
+   7719377011,  7721798359,  7724220239,  7726640502,  7729060896,  7731483346,
+   7733905622,  7736326209,  7738746954,  7741168843,  7743590570,  7746010688,
+   7748432257,  7750854002,  7753274854,  7755695802,  7758116869,  7760537625,
+   7762958104,  7765380970,  7767801721,  7770222710,  7772642796,  7775063575,
+   7777483583,  7779904587,  7782325725,  7784746398,  7787166915,  7789585850,
+   7792005556,  7794426880,  7796846453,  7799266367,  7801686185,  7804107030,
+   7806527994,  7808949188,  7811369974,  7813788553,  7816209513,  7818630279,
+   7821049346,  7823469405,  7825888114,  7828308227,  7830728086,  7833147135,
+   7835567680,  7837987558,  7840408367,  7842828391,  7845249398,  7847668456,
+   7850087755,  7852506944,  7854926841,  7857346423,  7859765905,  7862185146,
+   7864604974,  7867023477,  7869442172,  7871862076,  7874282414,  7876699945,
+   7879119414,  7881538285,  7883957290,  7886376944,  7888796777,  7891215133,
+   7893635118,  7896054713,  7898474525,  7900892511,  7903311626,  7905731398,
+   7908151202,  7910569848,  7912990033,  7915408658,  7917827261,  7920246253,
+   7922665496,  7925084094,  7927502776,  7929921493,  7932339902,  7934759907,
+   7937179988,  7939598828,  7942017309,  7944436179,  7946854589,  7949273282,
+   7951691465,  7954108592,  7956525806,  7958944088,  7961362860,  7963781671,
+   7966199322,  7968617606,  7971036812,  7973455262,  7975874040,  7978292530,
+   7980711855,  7983131064,  7985549182,  7987967348,  7990385838,  7992804152,
+   7995222705,  7997640362,  8000059080,  8002476340,  8004893631,  8007312342,
+   8009728547,  8012146250,  8014564146,  8016982334,  8019399246,  8021817094,
+   8024233765,  8026651907,  8029070791,  8031488151,  8033906559,  8036324602,
+   8038742458,  8041159721,  8043577934,  8045996386,  8048413359,  8050829968,
+   8053246144,  8055663021,  8058080569,  8060498657,  8062915443,  8065332335,
+   8067750542,  8070167019,  8072583894,  8075000963,  8077418378,  8079835059,
+   8082249668,  8084664901,  8087080983,  8089497087,  8091913563,  8094330000,
+   8096747069,  8099162720,  8101579486,  8103995050,  8106411004,  8108827247,
+   8111243948,  8113661224,  8116079230,  8118494642,  8120910474,  8123326465,
+   8125743429,  8128157797,  8130572788,  8132990146,  8135404653,  8137821319,
+   8140238462,  8142654523,  8145070630,  8147485357,  8149903393,  8152319656,
+   8154734684,  8157150397,  8159566834,  8161983649,  8164400816,  8166818072,
+   8169234537,  8171648787,  8174064619,  8176480885,  8178897085,  8181311249,
+   8183726691,  8186142953,  8188558508,  8190974631,  8193389956,  8195805536,
+   8198220912,  8200635888,  8203051278,  8205467018,  8207884486,  8210298009,
+   8212714110,  8215130206,  8217545216,  8219960354,  8222375616,  8224791855,
+   8227206544,  8229621197,  8232036210,  8234451402,  8236866750,  8239280986,
+   8241695095,  8244110688,  8246526238,  8248940335,  8251355851,  8253770881,
+   8256185719,  8258600941,  8261015152,  8263430248,  8265843388,  8268257941,
+   8270672742,  8273088259,  8275502965,  8277916777,  8280331961,  8282746307,
+   8285161230,  8287575802,  8289990658,  8292404933,  8294819293,  8297233355,
+   8299648988,  8302063180,  8304477447,  8306892128,  8309308090,  8311722677,
+   8314135490,  8316549487,  8318963338,  8321378535,  8323793381,  8326206650,
+   8328620523,  8331033189,  8333446829,  8335860891,  8338274195,  8340686820,
+   8343100503,  8345515182,  8347929494,  8350343650,  8352756790,  8355171233,
+   8357584859,  8359999152,  8362412480,  8364825110,  8367238393,  8369652586,
+   8372065661,  8374478999,  8376890591,  8379304654,  8381719033,  8384131509,
+   8386545986,  8388958988,  8391372195,  8393785789,  8396198721,  8398612727,
+   8401025532,  8403439937,  8405852210,  8408266011,  8410678562,  8413090931,
+   8415502436,  8417915075,  8420327950,  8422742446,  8425156043,  8427570357,
+   8429983908,  8432395624,  8434806852,  8437219533,  8439631363,  8442044306,
+   8444457354,  8446868854,  8449282632,  8451694905,  8454105780,  8456518242,
+   8458930605,  8461343166,  8463755466,  8466169135,  8468580669,  8470992711,
+   8473404491,  8475817633,  8478230202,  8480640883,  8483052231,  8485464323,
+   8487877327,  8490288885,  8492701175,  8495115154,  8497526943,  8499938314,
+   8502350405,  8504763817,  8507175271,  8509587294,  8511999073,  8514410635,
+   8516823694,  8519234865,  8521644594,  8524056333,  8526467892,  8528878621,
+   8531291435,  8533703476,  8536114284,  8538527019,  8540939178,  8543351401,
+   8545762617,  8548172537,  8550584415,  8552995289,  8555405857,  8557818051,
+   8560229099,  8562640585,  8565051217,  8567461724,  8569873337,  8572285578,
+   8574696825,  8577109816,  8579522241,  8581934281,  8584344330,  8586756767,
+   8589166165,  8591577512,  8593987120,  8596397509,  8598809924,  8601221183,
+   8603632539,  8606044132,  8608455439,  8610867673,  8613278096,  8615687590,
+   8618099200,  8620508963,  8622919777,  8625329403,  8627740265,  8630150927,
+   8632561710,  8634970480,  8637381080,  8639791816,  8642203429,  8644614091,
+   8647024866,  8649435921,  8651846349,  8654255513,  8656666032,  8659076032,
+   8661486720,  8663897816,  8666307367,  8668717566,  8671127504,  8673535829,
+   8675946640,  8678356914,  8680767106,  8683175815,  8685587627,  8687997238,
+   8690406713,  8692815398,  8695225538,  8697636235,  8700046480,  8702456207,
+   8704864825,  8707274745,  8709683938,  8712093066,  8714501851,  8716910560,
+   8719319090,  8721730152,  8724139670,  8726550115,  8728959206,  8731369199,
+   8733778623,  8736188446,  8738598310,  8741006976,  8743416381,  8745826161,
+   8748235875,  8750644975,  8753053721,  8755461759,  8757871272,  8760280906,
+   8762690512,  8765098554,  8767507537,  8769916873,  8772324796,  8774732190,
+   8777140468,  8779549835,  8781960291,  8784369996,  8786779730,  8789187843,
+   8791594557,  8794004995,  8796413545,  8798821784,  8801230428,  8803640127,
+   8806049067,  8808457555,  8810866605,  8813274875,  8815682074,  8818091293,
+   8820500431,  8822908471,  8825317014,  8827726692,  8830133926,  8832542493,
+   8834951628,  8837360380,  8839768580,  8842176646,  8844584546,  8846991934,
+   8849400954,  8851808817,  8854217502,  8856624988,  8859033339,  8861441939,
+   8863848625,  8866255984,  8868663640,  8871071991,  8873481620,  8875888697,
+   8878297094,  8880706216,  8883114098,  8885522003,  8887930458,  8890336233,
+   8892744287,  8895150259,  8897556898,  8899963620,  8902371065,  8904777345,
+   8907186081,  8909594023,  8912001510,  8914409215,  8916816092,  8919223863,
+   8921631668,  8924039597,  8926446203,  8928853547,  8931260304,  8933666107,
+   8936071822,  8938481039,  8940887733,  8943294184,  8945701703,  8948110530,
+   8950517668,  8952924222,  8955331528,  8957738982,  8960146352,  8962553159,
+   8964960637,  8967368782,  8969774677,  8972180898,  8974586398,  8976991990,
+   8979399446,  8981805835,  8984211924,  8986619510,  8989025793,  8991432044,
+   8993838520,  8996245819,  8998652956,  9001057842,  9003464522,  9005871008,
+   9008278445,  9010682901,  9013089944,  9015496501,  9017903768,  9020310121,
+   9022717455,  9025124052,  9027530028,  9029937410,  9032342441,  9034749080,
+   9037154447,  9039560915,  9041966065,  9044371950,  9046778075,  9049183659,
+   9051590621,  9053995780,  9056402517,  9058809663,  9061214624,  9063620482,
+   9066026491,  9068432569,  9070837375,  9073242599,  9075647910,  9078053820,
+   9080458718,  9082865516,  9085274342,  9087679564,  9090083749,  9092489626,
+   9094896918,  9097301747,  9099707815,  9102114788,  9104520050,  9106925487,
+   9109331840,  9111735581,  9114140935,  9116544410,  9118949282,  9121354019,
+   9123760017,  9126164057,  9128569370,  9130972829,  9133378058,  9135782154,
+   9138187656,  9140591834,  9142996577,  9145400761,  9147805501,  9150211269,
+   9152615680,  9155019909,  9157424991,  9159829546,  9162235328,  9164639788,
+   9167044122,  9169448707,  9171853657,  9174259188,  9176662403,  9179067038,
+   9181471284,  9183874132,  9186279534,  9188684081,  9191086701,  9193492274,
+   9195897932,  9198301985,  9200706224,  9203111211,  9205513708,  9207917824,
+   9210321792,  9212726501,  9215132413,  9217536867,  9219940519,  9222343864,
+   9224747595,  9227151972,  9229555141,  9231959183,  9234364254,  9236768803,
+   9239172099,  9241576335,  9243980510,  9246384122,  9248788433,  9251192221,
+   9253595703,  9256000379,  9258404399,  9260808071,  9263210911,  9265616233,
+   9268019765,  9270422723,  9272826231,  9275230551,  9277633974,  9280038680,
+   9282442717,  9284844354,  9287248390,  9289652707,  9292057465,  9294460585,
+   9296865242,  9299268876,  9301671149,  9304074636,  9306477056,  9308880257,
+   9311283718,  9313687885,  9316089468,  9318492003,  9320896031,  9323299484,
+   9325703485,  9328106776,  9330510777,  9332912093,  9335316220,  9337720558,
+   9340123006,  9342525187,  9344926840,  9347330171,  9349733956,  9352136284,
+   9354539724,  9356943515,  9359347177,  9361750950,  9364154515,  9366556918,
+   9368961019,  9371364330,  9373766813,  9376170150,  9378573912,  9380976224,
+   9383378608,  9385780890,  9388183026,  9390585293,  9392987689,  9395389725,
+   9397792259,  9400194285,  9402597169,  9404999600,  9407399532,  9409802105,
+   9412204831,  9414608344,  9417010272,  9419411916,  9421813640,  9424216360,
+   9426620418,  9429022368,  9431422580,  9433825061,  9436227319,  9438630196,
+   9441032543,  9443434804,  9445835618,  9448238438,  9450641305,  9453043754,
+   9455445406,  9457846926,  9460249741,  9462651291,  9465053908,  9467456549,
+   9469857658,  9472258451,  9474661039,  9477061338,  9479462263,  9481862037,
+   9484263119,  9486664911,  9489065936,  9491469015,  9493870531,  9496273851,
+   9498674361,  9501075536,  9503477029,  9505878682,  9508278738,  9510680536,
+   9513080866,  9515482386,  9517885455,  9520287059,  9522688580,  9525090794,
+   9527491993,  9529893607,  9532293954,  9534695419,  9537095145,  9539497183,
+   9541897951,  9544297963,  9546699706,  9549100926,  9551501152,  9553902219,
+   9556302045,  9558703118,  9561103707,  9563505246,  9565906171,  9568306909,
+   9570708364,  9573108094,  9575508157,  9577908209,  9580309461,  9582708873,
+   9585110831,  9587511690,  9589911470,  9592313656,  9594712705,  9597112950,
+   9599512761,  9601913401,  9604313090,  9606714653,  9609115415,  9611515328,
+   9613915333,  9616315384,  9618716024,  9621115502,  9623515231,  9625914734,
+   9628314474,  9630714586,  9633114156,  9635515134,  9637913622,  9640313046,
+   9642712093,  9645111000,  9647511344,  9649912249,  9652312361,  9654711337,
+   9657110381,  9659510083,  9661910128,  9664309884,  9666710285,  9669109372,
+   9671508061,  9673907738,  9676306644,  9678706199,  9681104326,  9683502789,
+   9685901159,  9688301301,  9690701850,  9693100334,  9695500893,  9697899442,
+   9700299757,  9702699623,  9705099690,  9707498939,  9709898414,  9712296452,
+   9714696309,  9717096718,  9719494710,  9721893936,  9724293408,  9726691944,
+   9729090590,  9731491029,  9733889042,  9736289551,  9738687189,  9741086277,
+   9743485114,  9745883523,  9748282317,  9750682433,  9753082083,  9755480442,
+   9757880407,  9760278412,  9762676220,  9765075165,  9767474032,  9769872657,
+   9772271295,  9774670942,  9777068154,  9779467153,  9781866642,  9784264618,
+   9786663171,  9789062386,  9791460738,  9793859799,  9796257855,  9798655869,
+   9801053724,  9803452301,  9805850934,  9808249393,  9810647370,  9813044540,
+   9815442075,  9817841343,  9820238411,  9822636013,  9825034721,  9827431744,
+   9829829565,  9832228773,  9834625538,  9837023275,  9839420933,  9841818250,
+   9844217711,  9846615332,  9849013325,  9851410118,  9853807984,  9856206971,
+   9858604259,  9861002154,  9863399682,  9865797522,  9868196177,  9870592369,
+   9872991128,  9875389583,  9877786190,  9880184442,  9882580344,  9884978101,
+   9887376435,  9889773130,  9892170715,  9894568076,  9896964934,  9899362461,
+   9901759823,  9904156026,  9906554833,  9908950609,  9911348728,  9913744478,
+   9916142076,  9918538038,  9920935329,  9923331520,  9925728874,  9928127652,
+   9930524451,  9932921354,  9935317904,  9937714440,  9940112007,  9942507597,
+   9944906643,  9947304996,  9949702854,  9952099180,  9954496144,  9956893595,
+   9959290729,  9961687615,  9964085596,  9966482374,  9968878405,  9971275903,
+   9973670852,  9976068181,  9978464091,  9980860078,  9983256992,  9985653847,
+   9988051432,  9990448511,  9992843451,  9995239775,  9997635651, 10000032056,
+  10002426542, 10004824015, 10007219828, 10009616025, 10012013156, 10014408156,
+  10016804948, 10019202058, 10021597898, 10023994790, 10026391211, 10028787438,
+  10031184050, 10033580265, 10035976766, 10038372687, 10040769947, 10043165497,
+  10045561785, 10047957013, 10050353170, 10052749171, 10055146482, 10057541962,
+  10059938753, 10062335546, 10064733203, 10067127963, 10069523726, 10071919434,
+  10074315879, 10076712378, 10079108611, 10081503519, 10083898523, 10086292839,
+  10088690069, 10091085640, 10093481837, 10095877503, 10098272534, 10100667459,
+  10103064252, 10105459517, 10107856178, 10110251668, 10112647197, 10115042065,
+  10117436155, 10119831161, 10122226643, 10124621181, 10127016192, 10129411364,
+  10131804466, 10134201058, 10136595465, 10138991499, 10141385489, 10143778819,
+  10146174332, 10148570739, 10150966549, 10153361146, 10155755134, 10158149644,
+  10160543959, 10162939881, 10165333939, 10167729842, 10170124667, 10172518560,
+  10174913608, 10177306900, 10179703260, 10182096243, 10184491591, 10186886825,
+  10189282002, 10191678169, 10194070820, 10196464877, 10198858592, 10201254804,
+  10203649507, 10206043839, 10208438993, 10210832960
+};
+
+/* Kerne fr das Vorsieben und Auswerten, vom langsamsten zum schnellsten */
+static const Kernels scalar_kernels = { "scalar", count_bits,        and_bytes };
+#ifdef X86_KERNELS
+static const Kernels popcnt_kernels = { "popcnt", count_bits_popcnt, and_bytes };
+static const Kernels avx2_kernels   = { "avx2",   count_bits_avx2,   and_bytes_avx2 };
+#endif
+
+/* Verfahren, die mit nthprime_set_engine gewhlt werden knnen */
+static const Engine segmented_engine   = { "segmented",   calc_primes,     sieve_primes_between };
+static const Engine incremental_engine = { "incremental", generate_primes, generate_primes_between };
+static const Engine* const engines[] = { &segmented_engine, &incremental_engine };
+
+/*==============================================================================
+  Schnittstelle (nthprime.h)
+==============================================================================*/
+
+/*------------------------------------------------------------------------------
+  Legt einen Kontext mit den Standardeinstellungen an.
+------------------------------------------------------------------------------*/
+NthPrime* nthprime_create(void) {
+  NthPrime* context;
+  if ((context = malloc(sizeof(*context))) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  context->threads_count = 1;
+  context->segment_bytes = detect_l1_cache_size();
+  context->kernels = select_kernels();
+  context->engine = NULL;
+  context->max_memory = 0;
+  context->physical_memory = detect_physical_memory();
+  for (uint32 i = 0; i < PRESIEVE_PATTERNS; i++) {
+    build_pattern(&context->presieve[i], presieve_primes[i]);
+  }
+  context->checkpoints = NULL;
+  context->timings = NULL;
+  context->progress = NULL;
+  return context;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt einen Kontext wieder frei.
+------------------------------------------------------------------------------*/
+void nthprime_destroy(NthPrime* context) {
+  if (context->checkpoints != NULL) {
+    close_checkpoints(context->checkpoints);
+  }
+  for (uint32 i = 0; i < PRESIEVE_PATTERNS; i++) {
+    free(context->presieve[i].bytes);
+  }
+  free(context);
+}
+
+/*------------------------------------------------------------------------------
+  Legt fest, wie viele Blcke des Siebs von eigenen Threads parallel
+  bearbeitet werden (1 bis MAX_THREADS).
+------------------------------------------------------------------------------*/
+void nthprime_set_threads(NthPrime* context, uint32 threads_count) {
+  context->threads_count = threads_count < 1           ? 1
+                         : threads_count > MAX_THREADS ? MAX_THREADS
+                         :                               threads_count;
+}
+
+/*------------------------------------------------------------------------------
+  Legt die Gre eines Segments des Siebs in Bytes fest (je 30 Zahlen).
+------------------------------------------------------------------------------*/
+void nthprime_set_segment_bytes(NthPrime* context, uint32 segment_bytes) {
+  context->segment_bytes = segment_bytes < 1                      ? 1
+                         : segment_bytes > MAX_SEGMENT_KIB * 1024U ? MAX_SEGMENT_KIB * 1024U
+                         :                                          segment_bytes;
+}
+
+/*------------------------------------------------------------------------------
+  Legt eine ungefhre Obergrenze fr den Speicher einer Abfrage fest
+  (0: keine). Darber werden die groen Primfaktoren als Abstnde
+  gespeichert und ohne Eimer gesiebt (calc_dense_limit), und pi(x) wird nur
+  so weit berechnet, wie seine Tabellen hineinpassen (calc_pi_limit, ohne
+  Obergrenze: in den Hauptspeicher).
+------------------------------------------------------------------------------*/
+void nthprime_set_max_memory(NthPrime* context, uint64 max_memory) {
+  context->max_memory = max_memory;
+}
+
+/*------------------------------------------------------------------------------
+  Whlt das Verfahren, mit dem die Primzahlen gemeldet werden, nach seinem
+  Namen ("auto": je Abfrage, siehe choose_engine).
+  Zurckgegeben wird -1, wenn es keins mit diesem Namen gibt.
+------------------------------------------------------------------------------*/
+int nthprime_set_engine(NthPrime* context, const char* name) {
+  if (strcmp(name, "auto") == 0) {
+    context->engine = NULL;
+    return 0;
+  }
+  for (uint32 i = 0; i < sizeof(engines) / sizeof(engines[0]); i++) {
+    if (strcmp(name, engines[i]->name) == 0) {
+      context->engine = engines[i];
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt den Namen des i-ten Verfahrens zurck (NULL: keins mehr).
+------------------------------------------------------------------------------*/
+const char* nthprime_engine_name(uint32 i) {
+  return i < sizeof(engines) / sizeof(engines[0]) ? engines[i]->name : NULL;
+}
+
+/*------------------------------------------------------------------------------
+  Verwendet die Checkpoint-Datei path (NULL: keine mehr).
+  Zurckgegeben wird -1, wenn sie nicht geffnet werden kann (siehe errno).
+------------------------------------------------------------------------------*/
+int nthprime_set_checkpoint_file(NthPrime* context, const char* path) {
+  if (context->checkpoints != NULL) {
+    close_checkpoints(context->checkpoints);
+    context->checkpoints = NULL;
+  }
+  if (path != NULL && (context->checkpoints = open_checkpoints(path)) == NULL) {
+    return -1;
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Misst die Laufzeiten der Phasen und addiert sie zu *timings (NULL: nicht
+  mehr messen).
+------------------------------------------------------------------------------*/
+void nthprime_set_timings(NthPrime* context, NthPrimeTimings* timings) {
+  context->timings = timings;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet den Fortschritt langer Abfragen etwa alle interval Sekunden an
+  callback (NULL: nie).
+------------------------------------------------------------------------------*/
+void nthprime_set_progress(NthPrime* context, double interval,
+                           NthPrimeProgressCallback callback, void* data) {
+  context->progress = callback;
+  context->progress_data = data;
+  context->progress_interval = interval;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die n-te Primzahl zurck (0, wenn sie nicht < 2^64 ist).
+------------------------------------------------------------------------------*/
+uint64 nthprime_nth_prime(NthPrime* context, uint64 n) {
+  uint64 prime = 0;
+  if (n > 0) {
+    Query query = make_query(context, MODE_PRIMES, n, keep_prime, &prime);
+    choose_engine(context, inverse_pi(n))->primes(&query, n);
+    finish_query(&query);
+  }
+  return prime;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Anzahl der Primzahlen <= x zurck.
+------------------------------------------------------------------------------*/
+uint64 nthprime_prime_pi(NthPrime* context, uint64 x) {
+  Query query = make_query(context, MODE_COUNT, ~0ULL, NULL, NULL);
+  uint64 pi = lookup_prime_pi(&query, x);
+  finish_query(&query);
+  return pi;
+}
+
+/*------------------------------------------------------------------------------
+  Prft, ob x eine Primzahl ist. Nach der Probedivision durch die Primzahlen
+  bis 53 entscheidet miller_rabin.
+------------------------------------------------------------------------------*/
+int nthprime_is_prime(uint64 x) {
+  if (x < 7) {
+    return x == 2 || x == 3 || x == 5;
+  }
+  if (x % 2 == 0 || x % 3 == 0 || x % 5 == 0) {
+    return 0;
+  }
+  for (uint32 i = 0; i < TRIAL_PRIMES; i++) {
+    if (x % local_primes[i] == 0) {
+      return x == local_primes[i];
+    }
+  }
+  return x < 59 * 59 || miller_rabin(x);
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die kleinste Primzahl > x zurck (0, wenn sie nicht < 2^64 ist).
+
+  Ab x wird jeweils ein Fenster von LOCAL_BYTES * 30 Zahlen mit den kleinen
+  Primzahlen gesiebt (sieve_local) und nur der Rest mit miller_rabin
+  geprft; der mittlere Abstand ist auch nahe 2^64 nur 44, ein Fenster
+  reicht also fast immer.
+------------------------------------------------------------------------------*/
+uint64 nthprime_next_prime(uint64 x) {
+  uint8 sieve[LOCAL_BYTES];
+  if (x < 7) {
+    return x < 2 ? 2 : x < 3 ? 3 : x < 5 ? 5 : 7;
+  }
+  if (x >= LARGEST_PRIME) {
+    return 0;
+  }
+  for (uint64 low = (x + 1) - (x + 1) % 30; ; low += 30ULL * LOCAL_BYTES) {
+    uint32 bytes = sieve_local(low, LOCAL_BYTES, sieve);
+    for (uint32 j = 0; j < bytes; j++) {
+      for (uint32 bits = sieve[j]; bits != 0; bits &= bits - 1) {
+        uint64 candidate = low + 30ULL * j + wheel[lowest_bit(bits)];
+        if (candidate > x && miller_rabin(candidate)) {
+          return candidate;
+        }
+      }
+    }
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die grte Primzahl < x zurck (0: keine), wie nthprime_next_prime
+  mit Fenstern abwrts.
+------------------------------------------------------------------------------*/
+uint64 nthprime_prev_prime(uint64 x) {
+  uint8 sieve[LOCAL_BYTES];
+  if (x <= 7) {
+    return x <= 2 ? 0 : x == 3 ? 2 : x <= 5 ? 3 : 5;
+  }
+  uint64 high = (x - 1) - (x - 1) % 30;   /* Anfang des obersten Bytes */
+  for ( ; ; high -= 30ULL * LOCAL_BYTES) {
+    uint64 low = high > 30ULL * (LOCAL_BYTES - 1) ? high - 30ULL * (LOCAL_BYTES - 1) : 0;
+    uint32 bytes = sieve_local(low, (uint32) ((high - low) / 30 + 1), sieve);
+    for (uint32 j = bytes; j-- > 0; ) {
+      for (uint32 k = 8; k-- > 0; ) {
+        uint64 offset = 30ULL * j + wheel[k];
+        if ((sieve[j] >> k & 1) && offset < x - low && miller_rabin(low + offset)) {
+          return low + offset;
+        }
+      }
+    }
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen von der n_start-ten bis zur n-ten an callback.
+  Zurckgegeben wird -1, wenn die n-te Primzahl nicht < 2^64 ist, sonst 0.
+------------------------------------------------------------------------------*/
+int nthprime_primes(NthPrime* context, uint64 n_start, uint64 n,
+                    NthPrimeCallback callback, void* data) {
+  if (n == 0) {
+    return 0;
+  }
+  Query query = make_query(context, MODE_PRIMES, n_start < 1 ? 1 : n_start, callback, data);
+  int result = choose_engine(context, inverse_pi(n))->primes(&query, n);
+  finish_query(&query);
+  return result;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet die Primzahlen aller Bereiche von der n_start[i]-ten bis zur n[i]-ten
+  an callback, aufsteigend und jede nur einmal.
+  Zurckgegeben wird -1 (und nichts gemeldet), wenn eine der n[i]-ten
+  Primzahlen nicht < 2^64 ist, sonst 0.
+------------------------------------------------------------------------------*/
+int nthprime_primes_batch(NthPrime* context, const uint64* n_start, const uint64* n,
+                          uint64 count, NthPrimeCallback callback, void* data) {
+  Range* ranges;
+  if ((ranges = malloc(sizeof(ranges[0]) * (count + 1))) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  uint64 ranges_count = 0;
+  for (uint64 i = 0; i < count; i++) {
+    if (n[i] > 0 && n_start[i] <= n[i]) {
+      ranges[ranges_count].n_start = n_start[i] < 1 ? 1 : n_start[i];
+      ranges[ranges_count].n = n[i];
+      ranges_count += 1;
+    }
+  }
+  ranges_count = merge_ranges(ranges, ranges_count);
+
+  int result = 0;
+  if (ranges_count > 0 && inverse_pi(ranges[ranges_count - 1].n) == 0) {
+    result = -1;
+  } else if (ranges_count > 0) {
+    Batch batch;
+    Query query = make_query(context, MODE_PRIMES, 1, batch_prime, &batch);
+    batch.query = &query;
+    batch.ranges = ranges;
+    batch.jump_seconds = 0;
+    batch.callback = callback;
+    batch.data = data;
+    calc_batch(&query, &batch, ranges_count);
+    finish_query(&query);
+  }
+  free(ranges);
+  return result;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen in [a, b] an callback. Die Nummer zhlt ab der
+  ersten Primzahl >= a.
+------------------------------------------------------------------------------*/
+void nthprime_primes_between(NthPrime* context, uint64 a, uint64 b,
+                             NthPrimeCallback callback, void* data) {
+  if (a > b || b < 2) {
+    return;
+  }
+  Query query = make_query(context, MODE_PRIMES, 1, callback, data);
+  choose_engine(context, b)->primes_between(&query, a, b);
+  finish_query(&query);
+}
+
+/*------------------------------------------------------------------------------
+  Schreibt die ersten (hchstens size) Primzahlen in [a, b] nach primes.
+  Zurckgegeben wird deren Anzahl.
+------------------------------------------------------------------------------*/
+uint64 nthprime_fill(NthPrime* context, uint64 a, uint64 b, uint64* primes, uint64 size) {
+  Fill fill;
+  fill.primes = primes;
+  fill.size = size;
+  fill.count = 0;
+  if (size > 0) {
+    nthprime_primes_between(context, a, b, fill_prime, &fill);
+  }
+  return fill.count;
+}
+
+/*------------------------------------------------------------------------------
+  Anzahl, Summe und Histogramm der Abstnde aller Primzahlen in [a, b].
+------------------------------------------------------------------------------*/
+uint64 nthprime_count(NthPrime* context, uint64 a, uint64 b) {
+  return get_statistics(context, MODE_COUNT, a, b, NULL).count;
+}
+
+void nthprime_sum(NthPrime* context, uint64 a, uint64 b, uint64* sum_hi, uint64* sum_lo) {
+  Statistics statistics = get_statistics(context, MODE_SUM, a, b, NULL);
+  *sum_hi = statistics.sum.hi;
+  *sum_lo = statistics.sum.lo;
+}
+
+void nthprime_gaps_histogram(NthPrime* context, uint64 a, uint64 b, uint64* gaps) {
+  memset(gaps, 0, sizeof(gaps[0]) * (MAX_GAP / 2 + 1));
+  get_statistics(context, MODE_GAPS, a, b, gaps);
+}
+
+/*------------------------------------------------------------------------------
+  Meldet die Abstnde >= min_gap bzw. die Rekordabstnde der Primzahlen in
+  [a, b] an callback.
+------------------------------------------------------------------------------*/
+void nthprime_gaps(NthPrime* context, uint64 a, uint64 b, uint64 min_gap,
+                   NthPrimeGapCallback callback, void* data) {
+  Search search;
+  memset(&search, 0, sizeof(search));
+  search.mode = MODE_GAP_SEARCH;
+  search.min_gap = min_gap;
+  search.gap_callback = callback;
+  search.data = data;
+  search_primes(context, &search, a, b);
+}
+
+void nthprime_record_gaps(NthPrime* context, uint64 a, uint64 b,
+                          NthPrimeGapCallback callback, void* data) {
+  Search search;
+  memset(&search, 0, sizeof(search));
+  search.mode = MODE_RECORDS;
+  search.gap_callback = callback;
+  search.data = data;
+  search_primes(context, &search, a, b);
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Tupel in [a, b], die zu einem der Muster passen, an callback.
+------------------------------------------------------------------------------*/
+void nthprime_tuples(NthPrime* context, uint64 a, uint64 b, const uint64* patterns,
+                     uint32 count, NthPrimeTupleCallback callback, void* data) {
+  Search search;
+  memset(&search, 0, sizeof(search));
+  search.mode = MODE_TUPLES;
+  search.tuples_count = count < MAX_PATTERNS ? count : MAX_PATTERNS;
+  for (uint32 i = 0; i < search.tuples_count; i++) {
+    build_tuple(&search.tuples[i], patterns[i]);
+  }
+  search.tuple_callback = callback;
+  search.data = data;
+  search_primes(context, &search, a, b);
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet das Teilergebnis fr [a, b]: die Anzahl wie nthprime_count, die
+  erste und letzte Primzahl mit nthprime_next_prime und nthprime_prev_prime.
+  Es hngt nur von [a, b] ab, so dass die Bereiche unabhngig voneinander
+  (in mehreren Prozessen oder auf mehreren Rechnern) berechnet werden knnen.
+------------------------------------------------------------------------------*/
+void nthprime_shard(NthPrime* context, uint64 a, uint64 b, NthPrimeShard* shard) {
+  shard->a = a;
+  shard->b = b;
+  shard->count = nthprime_count(context, a, b);
+  shard->first = 0;
+  shard->last = 0;
+  shard->index = 0;
+  if (shard->count > 0) {
+    shard->first = a <= 2 ? 2 : nthprime_next_prime(a - 1);
+    shard->last = b == ~0ULL ? LARGEST_PRIME : nthprime_prev_prime(b + 1);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Fgt Teilergebnisse zusammen: nach a geordnet mssen sie lckenlos
+  aneinander grenzen, sonst wird -1 zurckgegeben. Die Nummer der ersten
+  Primzahl ist pi(a - 1) + 1 fr den ersten Bereich (berechnet, wenn er
+  nicht bei 1 beginnt), danach wird addiert.
+------------------------------------------------------------------------------*/
+int nthprime_merge_shards(NthPrime* context, NthPrimeShard* shards, uint64 count) {
+  if (count == 0) {
+    return 0;
+  }
+  qsort(shards, count, sizeof(shards[0]), compare_shards);
+  for (uint64 i = 0; i < count; i++) {
+    if (   shards[i].a > shards[i].b
+        || (i > 0 && (shards[i - 1].b == ~0ULL || shards[i].a != shards[i - 1].b + 1))) {
+      return -1;
+    }
+  }
+  uint64 index = 1 + (shards[0].a > 1 ? nthprime_prime_pi(context, shards[0].a - 1) : 0);
+  for (uint64 i = 0; i < count; i++) {
+    shards[i].index = index;
+    index += shards[i].count;
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Vergleicht zwei Teilergebnisse nach a (fr qsort).
+------------------------------------------------------------------------------*/
+static int compare_shards(const void* a, const void* b) {
+  uint64 a_start = ((const NthPrimeShard*) a)->a;
+  uint64 b_start = ((const NthPrimeShard*) b)->a;
+  return a_start < b_start ? -1 : a_start > b_start;
+}
+
+/*------------------------------------------------------------------------------
+  Legt einen Iterator ab start an.
+
+  Der Iterator siebt jeweils ein Fenster von ITERATOR_WINDOW Zahlen und merkt
+  sich dessen Primzahlen. Die Primfaktoren werden nur dann neu berechnet, wenn
+  ein Fenster ber factors_limit hinaus reicht, und zwar gleich bis zum
+  Vierfachen.
+------------------------------------------------------------------------------*/
+NthPrimeIterator* nthprime_iterator_create(NthPrime* context, uint64 start) {
+  NthPrimeIterator* iterator;
+  if ((iterator = calloc(1, sizeof(*iterator))) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  iterator->context = *context;
+  iterator->next_from = start;
+  iterator->prev_below = start;
+  iterator->low = 1;
+  iterator->high = 0;
+  return iterator;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt einen Iterator wieder frei.
+------------------------------------------------------------------------------*/
+void nthprime_iterator_destroy(NthPrimeIterator* iterator) {
+  free(iterator->primes);
+  free_prime_factors(&iterator->factors);
+  free(iterator);
+}
+
+/*------------------------------------------------------------------------------
+  Liefert die nchste Primzahl (0: keine mehr < 2^64).
+------------------------------------------------------------------------------*/
+uint64 nthprime_iterator_next(NthPrimeIterator* iterator) {
+  uint64 low = iterator->next_from;
+
+  while (1) {
+    if (iterator->low <= low && low <= iterator->high) {
+      uint64 i = find_prime(iterator, low);
+      if (i < iterator->count) {
+        return move_iterator(iterator, iterator->primes[i]);
+      }
+      if (iterator->high == ~0ULL) {
+        return 0;
+      }
+      low = iterator->high + 1;
+    }
+    uint64 high = low + (ITERATOR_WINDOW - 1);
+    sieve_window(iterator, low, high < low ? ~0ULL : high);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Liefert die vorige Primzahl (0: keine mehr).
+------------------------------------------------------------------------------*/
+uint64 nthprime_iterator_prev(NthPrimeIterator* iterator) {
+  uint64 below = iterator->prev_below;
+
+  while (1) {
+    if (below <= 2) {
+      return 0;
+    }
+    if (iterator->low <= below - 1 && below - 1 <= iterator->high) {
+      uint64 i = find_prime(iterator, below);
+      if (i > 0) {
+        return move_iterator(iterator, iterator->primes[i - 1]);
+      }
+      below = iterator->low;
+      continue;
+    }
+    sieve_window(iterator, below > ITERATOR_WINDOW ? below - ITERATOR_WINDOW : 0, below - 1);
+  }
+}
+
+/*==============================================================================
+  Abfragen
+==============================================================================*/
+
+/*------------------------------------------------------------------------------
+  Stellt eine Abfrage mit den Einstellungen des Kontexts zusammen.
+------------------------------------------------------------------------------*/
+static Query make_query(NthPrime* context, Mode mode, uint64 n_start,
+                 NthPrimeCallback callback, void* data) {
+  Query query;
+  query.threads_count = context->threads_count;
+  query.segment_bytes = context->segment_bytes;
+  query.kernels = context->kernels;
+  query.presieve = context->presieve;
+  query.max_memory = context->max_memory;
+  query.pi_memory = context->max_memory != 0 ? context->max_memory : context->physical_memory;
+  query.mode = mode;
+  query.n_start = n_start;
+  query.callback = callback;
+  query.data = data;
+  query.stopped = 0;
+  query.checkpoints = context->checkpoints;
+  memset(&query.timings, 0, sizeof(query.timings));
+  query.timings_total = context->timings;
+  query.started = get_seconds();
+  query.progress = context->progress;
+  query.progress_data = context->progress_data;
+  query.progress_interval = context->progress_interval;
+  query.progress_next = query.started + query.progress_interval;
+  query.phase_started = query.started;
+  query.segments = 0;
+  query.crossings = 0;
+  return query;
+}
+
+/*------------------------------------------------------------------------------
+  Beendet eine Abfrage: addiert ihre Laufzeiten zu denen des Kontexts.
+------------------------------------------------------------------------------*/
+static void finish_query(Query* query) {
+  NthPrimeTimings* total = query->timings_total;
+  if (total != NULL) {
+    total->total    += get_seconds() - query->started;
+    total->bound    += query->timings.bound;
+    total->base     += query->timings.base;
+    total->segments += query->timings.segments;
+    total->output   += query->timings.output;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Addiert die seit start vergangene Zeit zur Laufzeit einer Phase.
+------------------------------------------------------------------------------*/
+static void add_timing(Query* query, Phase phase, double start) {
+  double seconds = get_seconds() - start;
+  switch (phase) {
+    case PHASE_BOUND:    query->timings.bound    += seconds; break;
+    case PHASE_BASE:     query->timings.base     += seconds; break;
+    case PHASE_SEGMENTS: query->timings.segments += seconds; break;
+    case PHASE_OUTPUT:   query->timings.output   += seconds; break;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Meldet den Fortschritt an query->progress, wenn seit dem letzten Bericht
+  progress_interval Sekunden vergangen sind.
+------------------------------------------------------------------------------*/
+static void report_progress(Query* query, int phase, double done, uint64 z, uint64 numbers,
+                            uint64 primes) {
+  if (query->progress == NULL) {
+    return;
+  }
+  double now = get_seconds();
+  if (now < query->progress_next) {
+    return;
+  }
+  NthPrimeProgress progress;
+  progress.phase = phase;
+  progress.seconds = now - query->started;
+  progress.phase_seconds = now - query->phase_started;
+  progress.done = done < 0 ? 0 : done > 1 ? 1 : done;
+  progress.z = z;
+  progress.numbers = numbers;
+  progress.primes = primes;
+  progress.segments = query->segments;
+  progress.crossings = query->crossings;
+  progress.marking = query->timings.segments;
+  progress.scanning = query->timings.output;
+  query->progress(query->progress_data, &progress);
+  query->progress_next = now + query->progress_interval;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet eine Primzahl und deren Nummer an query->callback.
+
+  Zahlen deren Nummer kleiner als n_start ist, werden nicht gemeldet.
+  Zurckgegeben wird, ob die Abfrage abgebrochen wurde.
+------------------------------------------------------------------------------*/
+static int report_prime(Query* query, uint64 index, uint64 prime_number) {
+  if (index >= query->n_start && query->callback(query->data, index, prime_number) != 0) {
+    query->stopped = 1;
+  }
+  return query->stopped;
+}
+
+/*------------------------------------------------------------------------------
+  Callbacks fr nthprime_nth_prime, nthprime_fill und den Iterator.
+------------------------------------------------------------------------------*/
+static int keep_prime(void* data, uint64 index, uint64 prime_number) {
+  (void) index;
+  *(uint64*) data = prime_number;
+  return 1;
+}
+
+static int fill_prime(void* data, uint64 index, uint64 prime_number) {
+  Fill* fill = data;
+  (void) index;
+  fill->primes[fill->count++] = prime_number;
+  return fill->count >= fill->size;
+}
+
+/*------------------------------------------------------------------------------
+  Callback fr nthprime_primes_batch: gibt die Primzahl weiter und setzt am
+  Ende eines Bereichs query->n_start auf den Anfang des nchsten, so dass die
+  Blcke dazwischen nur gezhlt werden.
+------------------------------------------------------------------------------*/
+static int batch_prime(void* data, uint64 index, uint64 prime_number) {
+  Batch* batch = data;
+  if (batch->callback(batch->data, index, prime_number) != 0) {
+    return 1;
+  }
+  if (index == batch->ranges[batch->current].n && batch->current < batch->last) {
+    batch->current += 1;
+    batch->query->n_start = batch->ranges[batch->current].n_start;
+  }
+  return 0;
+}
+
+static int append_prime(void* data, uint64 index, uint64 prime_number) {
+  NthPrimeIterator* iterator = data;
+  (void) index;
+  if (iterator->count == iterator->capacity) {
+    iterator->capacity = iterator->capacity == 0 ? 4096 : 2 * iterator->capacity;
+    iterator->primes = realloc(iterator->primes, sizeof(iterator->primes[0]) * iterator->capacity);
+    if (iterator->primes == NULL) {
+      perror("memory error");
+      exit(4);
+    }
+  }
+  iterator->primes[iterator->count++] = prime_number;
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Ermittelt die Gre des L1-Daten-Caches in Bytes.
+------------------------------------------------------------------------------*/
+static uint32 detect_l1_cache_size(void) {
+#ifdef _WIN32
+  SYSTEM_LOGICAL_PROCESSOR_INFORMATION info[256];
+  DWORD size = sizeof(info);
+  if (GetLogicalProcessorInformation(info, &size)) {
+    for (DWORD i = 0; i < size / sizeof(info[0]); i++) {
+      if (   info[i].Relationship == RelationCache
+          && info[i].Cache.Level == 1
+          && info[i].Cache.Type != CacheInstruction
+          && info[i].Cache.Size > 0
+          && info[i].Cache.Size <= MAX_SEGMENT_KIB * 1024UL) {
+        return info[i].Cache.Size;
+      }
+    }
+  }
+#elif defined(_SC_LEVEL1_DCACHE_SIZE)
+  long size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+  if (size > 0 && size <= MAX_SEGMENT_KIB * 1024L) {
+    return (uint32) size;
+  }
+#endif
+  return DEFAULT_SEGMENT_BYTES;
+}
+
+/*------------------------------------------------------------------------------
+  Ermittelt die Gre des Hauptspeichers in Bytes (0: unbekannt).
+------------------------------------------------------------------------------*/
+static uint64 detect_physical_memory(void) {
+#ifdef _WIN32
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if (GlobalMemoryStatusEx(&status)) {
+    return status.ullTotalPhys;
+  }
+#elif defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long page_size = sysconf(_SC_PAGESIZE);
+  if (pages > 0 && page_size > 0) {
+    return (uint64) pages * (uint64) page_size;
+  }
+#endif
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Whlt die schnellsten Kerne, die der Prozessor ausfhren kann.
+
+  Mit der Umgebungsvariablen NTHPRIME_KERNELS (scalar, popcnt, avx2) lsst
+  sich ein langsamerer Kern erzwingen, z.B. zum Vergleichen.
+------------------------------------------------------------------------------*/
+static const Kernels* select_kernels(void) {
+  const Kernels* candidates[3];
+  uint32 candidates_count = 0;
+  candidates[candidates_count++] = &scalar_kernels;
+#if defined(X86_KERNELS) && defined(__GNUC__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt")) {
+    candidates[candidates_count++] = &popcnt_kernels;
+    if (__builtin_cpu_supports("avx2")) {
+      candidates[candidates_count++] = &avx2_kernels;
+    }
+  }
+#elif defined(X86_KERNELS)
+  int info[4];
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 23)) != 0) {
+    candidates[candidates_count++] = &popcnt_kernels;
+    /* AVX2 braucht auch die Untersttzung des Betriebssystems (XSAVE) */
+    int os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0
+                 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    if (os_avx && (info[1] & (1 << 5)) != 0) {
+      candidates[candidates_count++] = &avx2_kernels;
+    }
+  }
+#endif
+
+  const char* name = getenv("NTHPRIME_KERNELS");
+  if (name != NULL) {
+    for (uint32 i = 0; i < candidates_count; i++) {
+      if (strcmp(candidates[i]->name, name) == 0) {
+        return candidates[i];
+      }
+    }
+  }
+  return candidates[candidates_count - 1];
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Vorsieb-Muster: das Sieb (30 Zahlen je Byte) ab 0, in dem alle
+  Vielfachen der Primzahlen (auch sie selbst) gestrichen sind. Da sich das
+  Muster nach 30 * p Zahlen = p Bytes wiederholt, ist es so lang wie das
+  Produkt der Primzahlen.
+------------------------------------------------------------------------------*/
+static void build_pattern(Pattern* pattern, const uint32* primes) {
+  pattern->period = 1;
+  for (uint32 i = 0; primes[i] != 0; i++) {
+    pattern->period *= primes[i];
+  }
+  if ((pattern->bytes = malloc(pattern->period)) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  memset(pattern->bytes, 0xff, pattern->period);
+  for (uint32 j = 0; j < pattern->period; j++) {
+    for (uint32 k = 0; k < 8; k++) {
+      for (uint32 i = 0; primes[i] != 0; i++) {
+        if ((30 * j + wheel[k]) % primes[i] == 0) {
+          pattern->bytes[j] &= (uint8) ~(1 << k);
+        }
+      }
+    }
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Whlt das Verfahren fr eine Abfrage, deren Primzahlen hchstens bis x
+  reichen (0: zu gro).
+
+  Ohne Vorgabe (nthprime_set_engine) wird das inkrementelle Sieb nur bis
+  INCREMENTAL_MAX_X gewhlt, dort lohnt der Aufbau der Blcke noch nicht.
+  Darber ist das segmentierte Sieb schneller, gemessen auch fr kleine
+  Bereiche bei groen Zahlen (100 Zahlen bei 10^12: 4 ms gegen 15 ms), denn
+  das inkrementelle Sieb muss dort alle Primfaktoren bis zur Wurzel erst
+  selbst erzeugen.
+------------------------------------------------------------------------------*/
+static const Engine* choose_engine(NthPrime* context, uint64 x) {
+  if (context->engine != NULL) {
+    return context->engine;
+  }
+  return x != 0 && x <= INCREMENTAL_MAX_X ? &incremental_engine : &segmented_engine;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen von der n_start-ten bis zur n-ten.
+  Zurckgegeben wird -1, wenn die n-te Primzahl nicht < 2^64 ist, sonst 0.
+
+  Ab einem gengend groen n_start (oder einem passenden Checkpoint) werden
+  die Primzahlen davor nicht gesiebt, sondern mit pi(x) bersprungen. Die
+  Laufzeit hngt dann im Wesentlichen nur noch von der Breite des Bereichs
+  ab und nicht mehr von seiner Lage.
+------------------------------------------------------------------------------*/
+static int calc_primes(Query* query, uint64 n) {
+  double start = get_seconds();
+  uint64 p = inverse_pi(n);
+  add_timing(query, PHASE_BOUND, start);
+  if (p == 0) {
+    return -1;
+  }
+
+  if (report_prime(query, 1, 2) || n == 1) {
+    return 0;
+  }
+
+  Factors factors;
+  start = get_seconds();
+  build_prime_factors(p, calc_dense_limit(query, p), &factors);
+  add_timing(query, PHASE_BASE, start);
+  for (uint32 i = 0; i <= factors.primes_top; i++) {
+    if (report_prime(query, i + 2, factors.primes[i])) {
+      break;
+    }
+  }
+  if (n > 2 && query->stopped == 0) {
+    uint64 count_primes = factors.primes_top + 2;
+    uint64 z = calc_window_start(query, query->n_start, &factors, &count_primes);
+    calc_remaining_primes(query, n, z, p, count_primes, &factors);
+  }
+  free_prime_factors(&factors);
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen in [a, b] mit dem segmentierten Sieb.
+------------------------------------------------------------------------------*/
+static void sieve_primes_between(Query* query, uint64 a, uint64 b) {
+  Factors factors;
+  double start = get_seconds();
+  build_prime_factors(b, calc_dense_limit(query, b), &factors);
+  add_timing(query, PHASE_BASE, start);
+  calc_primes_between(query, a, b, &factors);
+  free_prime_factors(&factors);
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen in [a, b], gezhlt ab der ersten >= a.
+
+  factors enthlt alle ungeraden Primzahlen bis sqrt(b); die einzeln
+  gespeicherten werden direkt gemeldet, darber wird gesiebt.
+------------------------------------------------------------------------------*/
+static void calc_primes_between(Query* query, uint64 a, uint64 b, const Factors* factors) {
+  const uint32* primes = factors->primes;
+  uint32 primes_top = factors->primes_top;
+  uint64 count_primes = 0;
+  query->checkpoints = NULL;   /* die Nummern zhlen erst ab a */
+
+  if (a <= 2 && b >= 2) {
+    count_primes += 1;
+    if (report_prime(query, count_primes, 2)) {
+      return;
+    }
+  }
+  for (uint32 i = 0; i <= primes_top && primes[i] <= b; i++) {
+    if (primes[i] >= a) {
+      count_primes += 1;
+      if (report_prime(query, count_primes, primes[i])) {
+        return;
+      }
+    }
+  }
+
+  uint64 z_start = 2ULL + primes[primes_top];
+  if (z_start < a) {
+    z_start = a;
+  }
+  if (z_start <= b) {
+    calc_remaining_primes(query, ~0ULL, z_start, b, count_primes, factors);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Meldet die Primzahlen aller (sortierten, disjunkten) Bereiche in
+  batch->ranges.
+
+  Die Primfaktoren werden nur einmal fr den grten Bereich berechnet. Die
+  Bereiche werden dann aufsteigend in mglichst wenigen Durchgngen gesiebt:
+  ein Durchgang springt wie calc_primes mit pi(x) vor seinen ersten Bereich
+  und siebt weiter ber alle folgenden, solange das Sieben bis zum nchsten
+  billiger ist als ein neuer Sprung (prefer_sweep). Zwischen den Bereichen
+  wird nur gezhlt (siehe batch_prime).
+------------------------------------------------------------------------------*/
+static void calc_batch(Query* query, Batch* batch, uint64 ranges_count) {
+  Range* ranges = batch->ranges;
+  double start = get_seconds();
+  uint64 p = inverse_pi(ranges[ranges_count - 1].n);
+  add_timing(query, PHASE_BOUND, start);
+
+  Factors factors;
+  start = get_seconds();
+  build_prime_factors(p, calc_dense_limit(query, p), &factors);
+  add_timing(query, PHASE_BASE, start);
+  const uint32* primes = factors.primes;
+  uint64 table_top = factors.primes_top + 2ULL;   /* Nummer von primes[primes_top] */
+
+  for (uint64 first = 0; first < ranges_count && query->stopped == 0; ) {
+    uint64 count_primes = table_top;
+    uint64 z = 2ULL + primes[factors.primes_top];
+
+    /* Anfang in der Tabelle der Primfaktoren */
+    if (ranges[first].n_start <= table_top) {
+      for (uint64 i = ranges[first].n_start; i <= ranges[first].n && i <= table_top; i++) {
+        if (batch->callback(batch->data, i, i == 1 ? 2 : primes[i - 2]) != 0) {
+          query->stopped = 1;
+          break;
+        }
+      }
+      if (ranges[first].n <= table_top || query->stopped != 0) {
+        first += 1;
+        continue;
+      }
+      ranges[first].n_start = table_top + 1;
+    } else {
+      double bound = query->timings.bound;
+      z = calc_window_start(query, ranges[first].n_start, &factors, &count_primes);
+      if (query->timings.bound > bound) {
+        batch->jump_seconds = query->timings.bound - bound;
+        batch->jump_x = z;
+      }
+    }
+
+    uint64 last = first;
+    while (   last + 1 < ranges_count
+           && prefer_sweep(batch, ranges[last].n, ranges[last + 1].n_start)) {
+      last += 1;
+    }
+    uint64 z_end = inverse_pi(ranges[last].n);
+    Factors pass_factors = factors;   /* nur die bis sqrt(z_end) */
+    pass_factors.primes_top = find_primes_top(primes, factors.primes_top, integer_square_root(z_end));
+    if (pass_factors.primes_top < factors.primes_top) {
+      pass_factors.gaps_count = 0;
+    }
+    batch->current = first;
+    batch->last = last;
+    query->n_start = ranges[first].n_start;
+    calc_remaining_primes(query, ranges[last].n, z, z_end, count_primes, &pass_factors);
+    first = last + 1;
+  }
+  free_prime_factors(&factors);
+}
+
+/*------------------------------------------------------------------------------
+  Sortiert die Bereiche nach n_start und fasst berlappende und aneinander
+  grenzende zusammen. Zurckgegeben wird die neue Anzahl.
+------------------------------------------------------------------------------*/
+static uint64 merge_ranges(Range* ranges, uint64 ranges_count) {
+  if (ranges_count == 0) {
+    return 0;
+  }
+  qsort(ranges, ranges_count, sizeof(ranges[0]), compare_ranges);
+  uint64 merged = 0;
+  for (uint64 i = 1; i < ranges_count; i++) {
+    if (ranges[i].n_start - 1 <= ranges[merged].n) {
+      if (ranges[i].n > ranges[merged].n) {
+        ranges[merged].n = ranges[i].n;
+      }
+    } else {
+      ranges[++merged] = ranges[i];
+    }
+  }
+  return merged + 1;
+}
+
+static int compare_ranges(const void* a, const void* b) {
+  uint64 a_start = ((const Range*) a)->n_start;
+  uint64 b_start = ((const Range*) b)->n_start;
+  return a_start < b_start ? -1 : a_start > b_start;
+}
+
+/*------------------------------------------------------------------------------
+  Entscheidet, ob nach der n-ten Primzahl bis zur n_next-ten weiter gesiebt
+  oder mit pi(x) gesprungen wird.
+
+  Sobald ein Sprung gemessen ist, werden die Zeiten verglichen: die Dauer des
+  Sprungs, hochgerechnet mit x^(2/3), und die Zeit fr den Abstand bei der
+  bisherigen Geschwindigkeit des Siebs. Davor gilt prefer_sieve.
+------------------------------------------------------------------------------*/
+static int prefer_sweep(Batch* batch, uint64 n, uint64 n_next) {
+  if (n_next < PI_ENGINE_MIN_N) {
+    return 1;
+  }
+  uint64 x = n < PI_ENGINE_MIN_N ? 0 : inverse_li(n);
+  uint64 x_next = inverse_li(n_next);
+  uint64 distance = x_next > x ? x_next - x : 0;
+
+  Query* query = batch->query;
+  double sieve_seconds = query->timings.segments + query->timings.output;
+  if (batch->jump_seconds <= 0 || sieve_seconds <= 0) {
+    return prefer_sieve(distance, x_next);
+  }
+  double rate = 30.0 * query->segment_bytes * query->segments / sieve_seconds;
+  return   distance / rate
+        <= batch->jump_seconds * pow((double) x_next / (double) batch->jump_x, 2.0 / 3.0);
+}
+
+/*------------------------------------------------------------------------------
+  Gibt den Index der grten Primzahl <= x in primes[0..primes_top] zurck
+  (0, wenn es keine gibt).
+------------------------------------------------------------------------------*/
+static uint32 find_primes_top(const uint32* primes, uint32 primes_top, uint32 x) {
+  uint32 low = 0;
+  uint32 high = primes_top;
+  while (low < high) {
+    uint32 middle = low + (high - low + 1) / 2;
+    if (primes[middle] <= x) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return low;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Grenze zurck, bis zu der die Primfaktoren fr ein Sieb bis x
+  einzeln gespeichert werden (ohne Speichergrenze: alle).
+
+  Geschtzt wird, was sie mit ihren Eimern belegen (4 Bytes je Primzahl und
+  je Thread ein Eintrag in einem Eimer, mit Reserve fr das Wachsen). Passt
+  das nicht in max_memory, bleiben nur die kleinen einzeln (mindestens alle
+  bis MIN_DENSE_LIMIT, mit denen bis zur Wurzel gesiebt wird); die groen
+  kosten als halber Abstand nur ein Byte und werden ohne Eimer gesiebt
+  (cross_off_large).
+------------------------------------------------------------------------------*/
+static uint64 calc_dense_limit(const Query* query, uint64 x) {
+  if (query->max_memory == 0) {
+    return ~0ULL;
+  }
+  uint64 count = estimate_number_of_primes_up_to(integer_square_root(x));
+  uint64 memory = count * (sizeof(uint32) + 2 * sizeof(SievingPrime) * query->threads_count);
+  if (memory <= query->max_memory) {
+    return ~0ULL;
+  }
+  uint64 limit = 30ULL * ((query->segment_bytes + 1) / 2);   /* siehe build_blocks */
+  return limit > MIN_DENSE_LIMIT ? limit : MIN_DENSE_LIMIT;
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet alle ungeraden Primzahlen <= sqrt(x); die bis dense_limit kommen
+  einzeln nach factors->primes, alle greren als Abstnde nach
+  factors->gaps.
+------------------------------------------------------------------------------*/
+static void build_prime_factors(uint64 x, uint64 dense_limit, Factors* factors) {
+  uint32 root = integer_square_root(x);
+  factors->sqrt_x = root < 3 ? 3 : odd(root);
+
+  uint32 dense_x = dense_limit < factors->sqrt_x ? (uint32) dense_limit : factors->sqrt_x;
+  factors->primes = build_primes(estimate_number_of_primes_up_to(dense_x));
+  factors->gaps = NULL;
+  if (dense_x < factors->sqrt_x) {
+    factors->gaps = build_gaps(estimate_number_of_primes_up_to(factors->sqrt_x));
+  }
+  uint64* next = build_multiples(estimate_number_of_primes_up_to(integer_square_root(factors->sqrt_x) + 1));
+  char* sieve = build_sieve(BASE_CHUNK);
+  calc_prime_factors(factors, dense_limit, next, sieve);
+  free(sieve);
+  free(next);
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Primfaktoren wieder frei.
+------------------------------------------------------------------------------*/
+static void free_prime_factors(Factors* factors) {
+  free(factors->primes);
+  free(factors->gaps);
+  factors->primes = NULL;
+  factors->gaps = NULL;
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Array fr die Primfaktoren auf, das ausreichend gro ist.
+------------------------------------------------------------------------------*/
+static uint32* build_primes(uint32 prime_factors_count_estimated) {
+  uint32* primes;
+  size_t primes_size = sizeof(primes[0]) * prime_factors_count_estimated;
+  if ((primes = malloc(primes_size)) == NULL) {
+    perror("memory error");
+    exit(3);
+  }
+  return primes;
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Array fr die Abstnde der groen Primfaktoren auf, das
+  ausreichend gro ist (ein Byte je Primzahl).
+------------------------------------------------------------------------------*/
+static uint8* build_gaps(uint32 gaps_count_estimated) {
+  uint8* gaps;
+  if ((gaps = malloc(sizeof(gaps[0]) * gaps_count_estimated)) == NULL) {
+    perror("memory error");
+    exit(3);
+  }
+  return gaps;
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Array fr die nchsten Vielfachen von count Primzahlen auf.
+------------------------------------------------------------------------------*/
+static uint64* build_multiples(uint32 count) {
+  uint64* multiples;
+  if ((multiples = malloc(sizeof(multiples[0]) * count)) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  return multiples;
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Sieb mit size Bytes auf.
+------------------------------------------------------------------------------*/
+static char* build_sieve(uint32 size) {
+  char* sieve;
+  if ((sieve = malloc(sizeof(sieve[0]) * size)) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  return sieve;
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Rad-Sieb fr einen Block von 30 * bytes Zahlen auf.
+------------------------------------------------------------------------------*/
+static uint8* build_wheel_sieve(uint32 bytes) {
+  uint8* sieve;
+  if ((sieve = malloc(sizeof(sieve[0]) * bytes)) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  return sieve;
+}
+
+/*------------------------------------------------------------------------------
+  Baut ein Array fr die Siebzustnde der ersten count Primfaktoren auf
+  (Index wie primes).
+------------------------------------------------------------------------------*/
+static SievingPrime* build_sieving_primes(uint32 count) {
+  SievingPrime* sieving_primes;
+  if ((sieving_primes = malloc(sizeof(sieving_primes[0]) * count)) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  return sieving_primes;
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet alle ungeraden Primzahlen <= factors->sqrt_x.
+
+  Gesiebt wird in Stcken von BASE_CHUNK ungeraden Zahlen (ein Byte je
+  Zahl), der Speicher hngt also nicht von x ab. Eine Primzahl primes[i]
+  siebt ab dem Stck, in dem ihr Quadrat liegt, next[i] ist dann ihr nchstes
+  ungerades Vielfaches. Liegt das Quadrat schon im Stck der Primzahl selbst,
+  siebt sie gleich beim Notieren weiter vorne im Stck.
+
+  Primzahlen > dense_limit werden als halbe Abstnde zur vorigen notiert
+  (der grte Abstand unter 2^32 ist 336).
+------------------------------------------------------------------------------*/
+static void calc_prime_factors(Factors* factors, uint64 dense_limit, uint64* next, char* sieve) {
+  uint32* primes = factors->primes;
+  uint32 primes_top = 0;
+  uint32 active = 0;       /* primes[0..active - 1] sieben */
+  uint64 gaps_count = 0;
+  uint64 previous = 3;
+  primes[0] = 3;
+
+  for (uint64 low = 5; low <= factors->sqrt_x; low += 2ULL * BASE_CHUNK) {
+    uint64 high = low + 2ULL * (BASE_CHUNK - 1);
+    if (high > factors->sqrt_x) {
+      high = factors->sqrt_x;
+    }
+    uint32 size = (uint32) ((high - low) / 2 + 1);
+
+    /* Nicht-Primzahlen markieren */
+    memset(sieve, 0, size);
+    while (active <= primes_top && (uint64) primes[active] * primes[active] <= high) {
+      next[active] = (uint64) primes[active] * primes[active];
+      active += 1;
+    }
+    for (uint32 i = 0; i < active; i++) {
+      uint64 j = (next[i] - low) / 2;
+      for ( ; j < size; j += primes[i]) {
+        sieve[j] = 1;
+      }
+      next[i] = low + 2 * j;
+    }
+
+    /* Primzahlen notieren */
+    for (uint32 j = 0; j < size; j++) {
+      if (sieve[j] != 0) {
+        continue;
+      }
+      uint64 p = low + 2ULL * j;
+      if (p > dense_limit) {
+        factors->gaps[gaps_count++] = (uint8) ((p - previous) / 2);
+      } else {
+        primes[++primes_top] = (uint32) p;
+        if (active == primes_top && p * p <= high) {
+          uint64 k = (p * p - low) / 2;
+          for ( ; k < size; k += p) {
+            sieve[k] = 1;
+          }
+          next[active++] = low + 2 * k;
+        }
+      }
+      previous = p;
+    }
+  }
+
+  factors->primes_top = primes_top;
+  factors->gaps_count = gaps_count;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle ungeraden Primzahlen in [z_start, z_end] (> sqrt(z_end)), aber
+  nicht ber die n-te hinaus.
+
+  count_primes ist die Nummer der letzten Primzahl < z_start, factors muss
+  alle Primfaktoren <= sqrt(z_end) enthalten. Sind die Nummern absolut, wird fr
+  jedes Vielfache von CHECKPOINT_STRIDE, das gesiebt wird, ein Checkpoint
+  gespeichert.
+
+  Das Sieb ist ein Rad modulo 30: jedes Byte steht fr 30 Zahlen, von denen
+  nur die 8 zu 30 teilerfremden (1, 7, 11, ..., 29) je ein Bit belegen. Die
+  Primzahlen 2, 3 und 5 kommen darin nicht vor und werden vorab behandelt.
+
+  Es werden jeweils threads_count aufeinander folgende Blcke parallel
+  gesiebt und gezhlt, jeder Block hat dafr sein eigenes Sieb. Danach werden
+  die Blcke der Reihe nach ausgewertet. Ein Block wird nur dann nach den
+  einzelnen Primzahlen durchsucht, wenn darin etwas zu melden ist.
+------------------------------------------------------------------------------*/
+static void calc_remaining_primes(Query* query, uint64 n, uint64 z_start, uint64 z_end,
+                           uint64 count_primes, const Factors* factors) {
+  Block blocks[MAX_THREADS];
+
+  if (z_start <= 5) {
+    if (z_end < 5) {
+      return;
+    }
+    count_primes += 1;
+    if (report_prime(query, count_primes, 5) || count_primes >= n) {
+      return;
+    }
+    z_start = 7;
+  }
+  if (z_start > z_end) {
+    return;
+  }
+
+  uint64 low_start = z_start - z_start % 30;
+  uint32 block_bytes = build_blocks(query, blocks, low_start, z_end, factors);
+  uint64 step = 30ULL * block_bytes * query->threads_count;
+  uint64 count_start = count_primes;
+  query->phase_started = get_seconds();
+
+  for (uint64 low = low_start; ; low += step) {
+    double start = get_seconds();
+    sieve_blocks(query, blocks, low, z_start, z_end);
+    add_timing(query, PHASE_SEGMENTS, start);
+
+    /* Primzahlen der Reihe nach melden */
+    start = get_seconds();
+    for (uint32 t = 0; t < query->threads_count && count_primes < n && query->stopped == 0; t++) {
+      if (query->checkpoints != NULL) {
+        add_block_checkpoints(query->checkpoints, &blocks[t], count_primes);
+      }
+      if (count_primes + blocks[t].count < query->n_start) {
+        count_primes += blocks[t].count;
+      } else {
+        count_primes = report_block_primes(query, &blocks[t], count_primes, n);
+      }
+    }
+    add_timing(query, PHASE_OUTPUT, start);
+    if (count_primes >= n || query->stopped != 0 || z_end - low < step) {
+      break;
+    }
+    uint64 z = low + step - 1;
+    report_progress(query, NTHPRIME_PHASE_SIEVE,
+                    n != ~0ULL ? (double) (count_primes - count_start) / (double) (n - count_start)
+                               : (double) (z - z_start) / (double) (z_end - z_start),
+                    z, z - z_start + 1, count_primes);
+  }
+  free_blocks(query, blocks);
+}
+
+/*------------------------------------------------------------------------------
+  Meldet die Primzahlen eines gesiebten Blocks der Reihe nach, aber nicht
+  ber die n-te hinaus. Zurckgegeben wird die Nummer der letzten.
+
+  Das Sieb wird in 64-Bit-Wrtern gelesen; das nchste gesetzte Bit liefert
+  lowest_bit (ein Befehl), statt jedes Bit einzeln zu prfen. Stcke von
+  SCAN_BYTES vor der n_start-ten Primzahl werden nur gezhlt.
+------------------------------------------------------------------------------*/
+static uint64 report_block_primes(Query* query, Block* block, uint64 count_primes, uint64 n) {
+  for (uint32 i = 0; i < block->bytes; i += SCAN_BYTES) {
+    uint32 size = block->bytes - i < SCAN_BYTES ? block->bytes - i : SCAN_BYTES;
+    if (count_primes < query->n_start) {
+      uint64 count = block->kernels->count_bits(block->sieve + i, size);
+      if (count_primes + count < query->n_start) {
+        count_primes += count;
+        continue;
+      }
+    }
+    for (uint32 j = i; j < i + size; j += 8) {
+      for (uint64 bits = load_bits(block->sieve + j, block->bytes - j); bits != 0; bits &= bits - 1) {
+        uint32 b = lowest_bit(bits);
+        count_primes += 1;
+        if (   report_prime(query, count_primes, block->low + 30ULL * (j + b / 8) + wheel[b % 8])
+            || count_primes >= n) {
+          return count_primes;
+        }
+      }
+    }
+  }
+  return count_primes;
+}
+
+/*------------------------------------------------------------------------------
+  Bereitet fr jeden Thread einen Block ab low_start vor, der bis high reicht.
+  Zurckgegeben wird die Gre eines Blocks in Bytes.
+
+  Ein Block besteht aus ganzen Segmenten, ist aber nicht grer als ntig.
+  Ohne Eimer (factors->gaps, siehe cross_off_large) wird er so gro, wie es
+  der Speicher neben den Primfaktoren erlaubt, damit sich das Ansetzen der
+  groen Primzahlen je Block verteilt; mindestens aber ein Byte je Primzahl,
+  sonst wrde das Ansetzen das Sieben berwiegen.
+
+  Klein sind die Primzahlen ab primes[PRESIEVE_NEXT] bis vor large_start,
+  nur fr sie gibt es einen Siebzustand je Block (siehe init_block).
+------------------------------------------------------------------------------*/
+static uint32 build_blocks(Query* query, Block* blocks, uint64 low_start, uint64 high,
+                    const Factors* factors) {
+  uint64 range_bytes = (high - low_start) / 30 / query->threads_count + 1;
+  uint32 block_segment_bytes = query->segment_bytes;
+  if (block_segment_bytes > range_bytes) {
+    block_segment_bytes = range_bytes > MIN_SEGMENT_BYTES ? (uint32) range_bytes : MIN_SEGMENT_BYTES;
+    if (block_segment_bytes > query->segment_bytes) {
+      block_segment_bytes = query->segment_bytes;
+    }
+  }
+  uint64 block_segments = (range_bytes - 1) / block_segment_bytes + 1;
+  uint64 max_segments = SEGMENTS_PER_BLOCK;
+  if (factors->gaps != NULL) {
+    uint64 used = sizeof(uint32) * (factors->primes_top + 1ULL) + factors->gaps_count;
+    uint64 available = query->max_memory > used ? (query->max_memory - used) / query->threads_count : 0;
+    if (available < factors->gaps_count) {
+      available = factors->gaps_count;
+    }
+    if (available > MAX_BOUNDED_BLOCK_BYTES) {
+      available = MAX_BOUNDED_BLOCK_BYTES;
+    }
+    max_segments = available / block_segment_bytes;
+    if (max_segments < 1) {
+      max_segments = 1;
+    }
+  }
+  if (block_segments > max_segments) {
+    block_segments = max_segments;
+  }
+  if (query->mode == MODE_TUPLES && block_segments * block_segment_bytes < TUPLE_SEAM_BYTES) {
+    block_segments = (TUPLE_SEAM_BYTES - 1) / block_segment_bytes + 1;
+  }
+  uint32 block_bytes = block_segment_bytes * (uint32) block_segments;
+
+  uint32 large_start = PRESIEVE_NEXT;
+  while (   large_start <= factors->primes_top
+         && 2 * (factors->primes[large_start] / 30) < block_segment_bytes) {
+    large_start += 1;
+  }
+
+  for (uint32 t = 0; t < query->threads_count; t++) {
+    blocks[t].mode = query->mode;
+    blocks[t].kernels = query->kernels;
+    blocks[t].presieve = query->presieve;
+    blocks[t].bytes = block_bytes;
+    blocks[t].segment_bytes = block_segment_bytes;
+    blocks[t].buckets = NULL;
+    blocks[t].segment_number = 0;
+    blocks[t].primes_top = factors->primes_top;
+    blocks[t].primes = factors->primes;
+    blocks[t].factor_gaps = factors->gaps;
+    blocks[t].factor_gaps_count = factors->gaps_count;
+    blocks[t].large_start = large_start;
+    blocks[t].sieve = build_wheel_sieve(block_bytes);
+    blocks[t].sieving_primes = build_sieving_primes(large_start);
+    blocks[t].sieving_primes_low = 1;   /* noch nicht initialisiert */
+    blocks[t].crossings = 0;
+    blocks[t].gaps = NULL;
+    blocks[t].search = NULL;
+    blocks[t].found = NULL;
+    blocks[t].found_count = 0;
+    blocks[t].found_size = 0;
+    if (   query->mode == MODE_GAPS
+        && (blocks[t].gaps = malloc(sizeof(uint64) * (MAX_GAP / 2 + 1))) == NULL) {
+      perror("memory error");
+      exit(4);
+    }
+  }
+  return block_bytes;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt den Speicher der Blcke wieder frei.
+------------------------------------------------------------------------------*/
+static void free_blocks(Query* query, Block* blocks) {
+  for (uint32 t = 0; t < query->threads_count; t++) {
+    if (blocks[t].buckets != NULL) {
+      for (uint32 b = 0; b <= blocks[t].buckets_mask; b++) {
+        free(blocks[t].buckets[b].entries);
+      }
+      free(blocks[t].buckets);
+    }
+    free(blocks[t].sieve);
+    free(blocks[t].sieving_primes);
+    free(blocks[t].gaps);
+    free(blocks[t].found);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Siebt die threads_count aufeinander folgenden Blcke ab low parallel.
+  Bercksichtigt werden nur die Zahlen in [z_start, z_end].
+------------------------------------------------------------------------------*/
+static void sieve_blocks(Query* query, Block* blocks, uint64 low, uint64 z_start, uint64 z_end) {
+  Thread threads[MAX_THREADS];
+
+  for (uint32 t = 0; t < query->threads_count; t++) {
+    blocks[t].low = low + 30ULL * blocks[t].bytes * t;
+    blocks[t].z = blocks[t].low < z_start ? z_start : blocks[t].low;
+    blocks[t].z_end = z_end;
+    if (t > 0) {
+      threads[t] = start_block_thread(&blocks[t]);
+    }
+  }
+  sieve_block(&blocks[0]);
+  for (uint32 t = 1; t < query->threads_count; t++) {
+    join_block_thread(threads[t]);
+  }
+
+  for (uint32 t = 0; t < query->threads_count; t++) {
+    query->segments += blocks[t].bytes / blocks[t].segment_bytes;
+    query->crossings += blocks[t].crossings;
+    blocks[t].crossings = 0;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Speichert einen Checkpoint fr jedes Vielfache x von CHECKPOINT_STRIDE im
+  gesiebten Teil [z, z_end] eines Blocks. count_primes ist die Anzahl der
+  Primzahlen < block->z, die im Block davor werden aus dem Sieb gezhlt
+  (x selbst ist durch 30 teilbar, also keine Primzahl).
+------------------------------------------------------------------------------*/
+static void add_block_checkpoints(Checkpoints* checkpoints, Block* block, uint64 count_primes) {
+  uint64 x = block->z + (CHECKPOINT_STRIDE - block->z % CHECKPOINT_STRIDE) % CHECKPOINT_STRIDE;
+  for ( ;
+          x >= block->z && x <= block->z_end
+       && x - block->low < 30ULL * block->bytes;
+       x += CHECKPOINT_STRIDE) {
+    uint32 bytes = (uint32) ((x - block->low) / 30);
+    add_checkpoint(checkpoints, x, count_primes + block->kernels->count_bits(block->sieve, bytes));
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Ermittelt Anzahl, Summe oder Abstnde (je nach mode) aller Primzahlen in
+  [a, b]. gaps ist das Histogramm fr MODE_GAPS (mit 0 initialisiert).
+------------------------------------------------------------------------------*/
+static Statistics get_statistics(NthPrime* context, Mode mode, uint64 a, uint64 b, uint64* gaps) {
+  Statistics statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  statistics.gaps = gaps;
+  if (a <= b && b >= 2) {
+    Query query = make_query(context, mode, ~0ULL, NULL, NULL);
+    calc_statistics(&query, a, b, &statistics);
+    finish_query(&query);
+  }
+  return statistics;
+}
+
+/*------------------------------------------------------------------------------
+  Ermittelt Anzahl, Summe oder Abstnde aller Primzahlen in [a, b], ohne sie
+  einzeln zu melden.
+
+  Beim Zhlen eines groen Bereichs ist pi(b) - pi(a - 1) schneller als das
+  Sieben (prefer_sieve je Hlfte), solange pi(b) in den Speicher passt.
+------------------------------------------------------------------------------*/
+static void calc_statistics(Query* query, uint64 a, uint64 b, Statistics* statistics) {
+  if (   query->mode == MODE_COUNT && prefer_sieve((b - a) / 2, b) == 0
+      && b <= calc_pi_limit(query)) {
+    statistics->count = lookup_prime_pi(query, b) - (a < 2 ? 0 : lookup_prime_pi(query, a - 1));
+  } else {
+    sieve_statistics(query, a, b, statistics);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Siebt [a, b] fr calc_statistics und search_primes.
+
+  Die einzeln gespeicherten Primfaktoren (bis sqrt(b)) werden direkt
+  ausgewertet, fr alle greren Primzahlen die Blcke als Ganzes (gezhlt
+  wird mit popcount). Eine Suche braucht die Nachbarn jeder Primzahl im
+  Sieb und siebt deshalb schon ab 7.
+------------------------------------------------------------------------------*/
+static void sieve_statistics(Query* query, uint64 a, uint64 b, Statistics* statistics) {
+  Factors factors;
+  double start = get_seconds();
+  build_prime_factors(b, calc_dense_limit(query, b), &factors);
+  add_timing(query, PHASE_BASE, start);
+  const uint32* primes = factors.primes;
+  uint32 primes_top = factors.primes_top;
+
+  /* Primzahlen bis primes[primes_top] (bei einer Suche bis 5) */
+  uint64 z_start = a > 2ULL + primes[primes_top] ? a : 2ULL + primes[primes_top];
+  if (statistics->search != NULL) {
+    for (uint64 prime = 2; prime <= 5 && prime <= b; prime = prime == 2 ? 3 : prime + 2) {
+      if (prime >= a) {
+        add_prime_to_search(statistics->search, prime);
+      }
+    }
+    z_start = a > 7 ? a : 7;
+  } else {
+    if (a <= 2 && b >= 2) {
+      add_prime_to_statistics(statistics, 2);
+    }
+    for (uint32 i = 0; i <= primes_top && primes[i] <= b; i++) {
+      if (primes[i] >= a) {
+        add_prime_to_statistics(statistics, primes[i]);
+      }
+    }
+  }
+
+  /* Primzahlen > primes[primes_top] */
+  if (z_start < 7) {
+    if (z_start <= 5 && b >= 5) {
+      add_prime_to_statistics(statistics, 5);
+    }
+    z_start = 7;
+  }
+  if (z_start <= b) {
+    Block blocks[MAX_THREADS];
+    uint64 low_start = z_start - z_start % 30;
+    uint32 block_bytes = build_blocks(query, blocks, low_start, b, &factors);
+    for (uint32 t = 0; t < query->threads_count; t++) {
+      blocks[t].search = statistics->search;
+    }
+    query->phase_started = get_seconds();
+
+    for (uint64 low = low_start; ; low += 30ULL * block_bytes * query->threads_count) {
+      start = get_seconds();
+      sieve_blocks(query, blocks, low, z_start, b);
+      add_timing(query, PHASE_SEGMENTS, start);
+      start = get_seconds();
+      for (uint32 t = 0; t < query->threads_count; t++) {
+        if (statistics->search != NULL) {
+          statistics->count += blocks[t].count;
+          add_block_to_search(statistics->search, &blocks[t]);
+        } else {
+          add_block_to_statistics(statistics, &blocks[t]);
+        }
+      }
+      add_timing(query, PHASE_OUTPUT, start);
+      if (   b - low < 30ULL * block_bytes * query->threads_count
+          || (statistics->search != NULL && statistics->search->stopped)) {
+        break;
+      }
+      uint64 z = low + 30ULL * block_bytes * query->threads_count - 1;
+      report_progress(query, NTHPRIME_PHASE_SIEVE, (double) (z - z_start) / (double) (b - z_start),
+                      z, z - z_start + 1, statistics->count);
+    }
+    free_blocks(query, blocks);
+  }
+  if (statistics->search != NULL) {
+    finish_search(statistics->search);
+  }
+  free_prime_factors(&factors);
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt eine einzelne Primzahl (grer als alle bisherigen) in die
+  Statistik auf.
+------------------------------------------------------------------------------*/
+static void add_prime_to_statistics(Statistics* statistics, uint64 prime) {
+  statistics->count += 1;
+  add_128(&statistics->sum, multiply_64(prime, 1));
+  if (statistics->gaps != NULL && statistics->last != 0) {
+    add_gap(statistics->gaps, prime - statistics->last);
+  }
+  statistics->last = prime;
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt die Statistik eines gesiebten Blocks (der hinter allen bisherigen
+  Primzahlen liegt) in die Gesamtstatistik auf. Dazu gehrt auch der Abstand
+  zwischen der letzten bisherigen und der ersten Primzahl des Blocks.
+------------------------------------------------------------------------------*/
+static void add_block_to_statistics(Statistics* statistics, Block* block) {
+  if (block->count == 0) {
+    return;
+  }
+  statistics->count += block->count;
+  if (block->mode == MODE_SUM) {
+    add_128(&statistics->sum, block->sum);
+  }
+  if (block->mode == MODE_GAPS) {
+    if (statistics->last != 0) {
+      add_gap(statistics->gaps, block->first - statistics->last);
+    }
+    for (uint32 g = 0; g <= MAX_GAP / 2; g++) {
+      statistics->gaps[g] += block->gaps[g];
+    }
+    statistics->last = block->last;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Zhlt einen Abstand im Histogramm gaps[g / 2] (der Abstand 1 zwischen 2 und
+  3 landet in gaps[0]). Grere Abstnde als MAX_GAP gibt es unter 2^64 nicht.
+------------------------------------------------------------------------------*/
+static void add_gap(uint64* gaps, uint64 gap) {
+  gaps[(gap < MAX_GAP ? gap : MAX_GAP) / 2] += 1;
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet die Summe (MODE_SUM) oder die Abstnde (MODE_GAPS) der Primzahlen
+  eines gesiebten Blocks.
+
+  Fr die Summe werden nur die Abstnde der Primzahlen zu block->low addiert
+  und am Ende einmal count * low. Die Primzahlen werden wie in
+  report_block_primes wortweise gesucht.
+------------------------------------------------------------------------------*/
+static void calc_block_statistics(Block* block) {
+  if (block->mode == MODE_SUM) {
+    uint64 offsets = 0;
+    for (uint32 j = 0; j < block->bytes; j += 8) {
+      for (uint64 bits = load_bits(block->sieve + j, block->bytes - j); bits != 0; bits &= bits - 1) {
+        uint32 b = lowest_bit(bits);
+        offsets += 30ULL * (j + b / 8) + wheel[b % 8];
+      }
+    }
+    block->sum = multiply_64(block->count, block->low);
+    add_128(&block->sum, multiply_64(offsets, 1));
+  }
+
+  if (block->mode == MODE_GAPS) {
+    uint64 previous = 0;
+    block->first = 0;
+    memset(block->gaps, 0, sizeof(uint64) * (MAX_GAP / 2 + 1));
+    for (uint32 j = 0; j < block->bytes; j += 8) {
+      for (uint64 bits = load_bits(block->sieve + j, block->bytes - j); bits != 0; bits &= bits - 1) {
+        uint32 b = lowest_bit(bits);
+        uint64 offset = 30ULL * (j + b / 8) + wheel[b % 8];
+        if (block->first == 0) {
+          block->first = block->low + offset;
+        } else {
+          add_gap(block->gaps, offset - previous);
+        }
+        previous = offset;
+      }
+    }
+    block->last = block->low + previous;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Sucht Abstnde (MODE_GAP_SEARCH, MODE_RECORDS) oder Tupel (MODE_TUPLES) in
+  [a, b] und meldet sie an die Callbacks in search.
+
+  Die Blcke werden wie beim Zhlen parallel gesiebt, und jeder Thread sucht
+  in seinem Block (calc_block_search). Was ber die Grenze zweier Blcke
+  reicht, prft danach add_block_to_search der Reihe nach, so dass alles
+  aufsteigend gemeldet wird.
+------------------------------------------------------------------------------*/
+static void search_primes(NthPrime* context, Search* search, uint64 a, uint64 b) {
+  if (a <= b && b >= 2) {
+    Statistics statistics;
+    memset(&statistics, 0, sizeof(statistics));
+    statistics.search = search;
+    search->b = b;
+    Query query = make_query(context, search->mode, ~0ULL, NULL, NULL);
+    sieve_statistics(&query, a, b, &statistics);
+    finish_query(&query);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Bereitet ein Muster fr match_tuple vor.
+
+  Liegt p im Bit k eines Bytes (p % 30 = wheel[k]), dann liegt p + d im Sieb
+  immer gleich weit dahinter: 8 * ((wheel[k] + d) / 30) Bits fr die
+  ganzen Bytes und das Bit von (wheel[k] + d) % 30, also hchstens 31 Bits
+  fr d < 64. Ist (wheel[k] + d) % 30 nicht teilerfremd zu 30, kann das
+  Tupel nicht bei k beginnen. Ohne Bit 0 passt das Muster nie.
+------------------------------------------------------------------------------*/
+static void build_tuple(Tuple* tuple, uint64 pattern) {
+  tuple->pattern = pattern;
+  tuple->starts = 0;
+  tuple->shifts_count = 0;
+  if ((pattern & 1) == 0) {
+    return;
+  }
+  for (uint32 k = 0; k < 8; k++) {
+    uint32 count = 0;
+    uint32 d;
+    for (d = 1; d < 64; d++) {
+      if (pattern >> d & 1) {
+        uint32 r = wheel[k] + d;
+        if (wheel_bit[r % 30] == 0xff) {
+          break;
+        }
+        tuple->shifts[k][count++] = (uint8) (8 * (r / 30) + wheel_bit[r % 30] - k);
+      }
+    }
+    if (d == 64) {
+      tuple->starts |= 1U << k;
+      tuple->shifts_count = count;
+    }
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt eine der Primzahlen 2, 3 und 5 (vor dem Sieb) in die Suche auf. Ihre
+  Tupel reichen hchstens bis 68 und werden direkt geprft.
+------------------------------------------------------------------------------*/
+static void add_prime_to_search(Search* search, uint64 prime) {
+  if (search->mode == MODE_TUPLES) {
+    for (uint32 i = 0; i < search->tuples_count && ! search->stopped; i++) {
+      uint64 pattern = search->tuples[i].pattern;
+      uint32 d;
+      for (d = 0; d < 64; d++) {
+        if ((pattern >> d & 1) && (prime + d > search->b || ! is_small_prime(prime + d))) {
+          break;
+        }
+      }
+      if (d == 64 && (pattern & 1) != 0
+          && search->tuple_callback(search->data, prime, pattern) != 0) {
+        search->stopped = 1;
+      }
+    }
+  } else {
+    if (search->last != 0) {
+      report_gap(search, search->last, prime);
+    }
+    search->last = prime;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt die Fundstellen eines gesiebten Blocks (der hinter allen bisherigen
+  liegt) in die Suche auf und meldet sie.
+
+  Vorher kommt, was ber die Grenze zum vorigen Block reicht: der Abstand
+  zwischen dessen letzter und der ersten Primzahl des Blocks bzw. die Tupel,
+  die in den letzten TUPLE_SEAM_BYTES Bytes des vorigen Blocks beginnen.
+  Ein Tupel ist hchstens 4 Bytes lang, und ein Block hat mindestens
+  TUPLE_SEAM_BYTES Bytes (siehe build_blocks).
+------------------------------------------------------------------------------*/
+static void add_block_to_search(Search* search, Block* block) {
+  if (search->mode == MODE_TUPLES) {
+    report_tuples(search, search->tail_low, search->tail, load_bits(block->sieve, block->bytes));
+    for (uint64 i = 0; i < block->found_count && ! search->stopped; i++) {
+      uint64 pattern = search->tuples[block->found[2 * i + 1]].pattern;
+      if (search->tuple_callback(search->data, block->found[2 * i], pattern) != 0) {
+        search->stopped = 1;
+      }
+    }
+    search->tail = load_bits(block->sieve + block->bytes - TUPLE_SEAM_BYTES, TUPLE_SEAM_BYTES);
+    search->tail_low = block->low + 30ULL * (block->bytes - TUPLE_SEAM_BYTES);
+  } else if (block->count > 0) {
+    if (search->last != 0) {
+      report_gap(search, search->last, block->first);
+    }
+    for (uint64 i = 0; i < block->found_count && ! search->stopped; i++) {
+      report_gap(search, block->found[2 * i], block->found[2 * i + 1]);
+    }
+    search->last = block->last;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Meldet am Ende die Tupel, die im letzten Block beginnen (dahinter ist
+  alles gestrichen).
+------------------------------------------------------------------------------*/
+static void finish_search(Search* search) {
+  if (search->mode == MODE_TUPLES) {
+    report_tuples(search, search->tail_low, search->tail, 0);
+    search->tail = 0;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Meldet den Abstand der aufeinander folgenden Primzahlen p < q, wenn er
+  mindestens min_gap bzw. ein neuer Rekord ist. Die Rekorde eines Blocks
+  sind nur innerhalb des Blocks welche und werden hier mit dem bisher
+  grten Abstand verglichen.
+------------------------------------------------------------------------------*/
+static void report_gap(Search* search, uint64 p, uint64 q) {
+  if (search->stopped) {
+    return;
+  }
+  if (search->mode == MODE_RECORDS) {
+    if (q - p <= search->record) {
+      return;
+    }
+    search->record = q - p;
+  } else if (q - p < search->min_gap) {
+    return;
+  }
+  if (search->gap_callback(search->data, p, q) != 0) {
+    search->stopped = 1;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Tupel, die im Wort x (8 Bytes ab low) beginnen; y sind die 8
+  Bytes danach.
+------------------------------------------------------------------------------*/
+static void report_tuples(Search* search, uint64 low, uint64 x, uint64 y) {
+  uint64 matches[MAX_PATTERNS];
+  uint64 all = 0;
+  for (uint32 i = 0; i < search->tuples_count; i++) {
+    matches[i] = match_tuple(&search->tuples[i], x, y);
+    all |= matches[i];
+  }
+  for ( ; all != 0 && ! search->stopped; all &= all - 1) {
+    uint32 b = lowest_bit(all);
+    uint64 prime = low + 30ULL * (b / 8) + wheel[b % 8];
+    for (uint32 i = 0; i < search->tuples_count && ! search->stopped; i++) {
+      if (   (matches[i] >> b & 1)
+          && search->tuple_callback(search->data, prime, search->tuples[i].pattern) != 0) {
+        search->stopped = 1;
+      }
+    }
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Bits im Wort x zurck, an denen ein Tupel beginnt; y sind die 64
+  Bits danach.
+
+  Fr jeden Rest k wird x auf die Bits k aller Bytes maskiert und mit x um
+  die Abstnde der brigen Primzahlen verschoben verknpft, also alle 8
+  mglichen Anfnge eines Restes auf einmal geprft.
+------------------------------------------------------------------------------*/
+static uint64 match_tuple(const Tuple* tuple, uint64 x, uint64 y) {
+  uint64 matches = 0;
+  for (uint32 k = 0; k < 8; k++) {
+    if (tuple->starts >> k & 1) {
+      uint64 m = x & 0x0101010101010101ULL << k;
+      for (uint32 i = 0; i < tuple->shifts_count && m != 0; i++) {
+        uint32 s = tuple->shifts[k][i];
+        m &= x >> s | y << (64 - s);
+      }
+      matches |= m;
+    }
+  }
+  return matches;
+}
+
+/*------------------------------------------------------------------------------
+  Sucht in einem gesiebten Block (im Thread des Blocks) und sammelt die
+  Fundstellen in block->found.
+
+  Abstnde: alle >= min_gap bzw. die Rekorde innerhalb des Blocks, dazu die
+  erste und letzte Primzahl fr die Grenzen zu den Nachbarn.
+  Tupel: alle, die vor den letzten TUPLE_SEAM_BYTES Bytes beginnen, mit
+  match_tuple wortweise.
+------------------------------------------------------------------------------*/
+static void calc_block_search(Block* block) {
+  const Search* search = block->search;
+  block->found_count = 0;
+
+  if (block->mode == MODE_TUPLES) {
+    uint64 matches[MAX_PATTERNS];
+    uint32 end = block->bytes - TUPLE_SEAM_BYTES;
+    for (uint32 j = 0; j < end; j += 8) {
+      uint64 x = load_bits(block->sieve + j, block->bytes - j);
+      uint64 y = load_bits(block->sieve + j + 8, block->bytes - j - 8);
+      uint64 all = 0;
+      if (x == 0) {
+        continue;
+      }
+      for (uint32 i = 0; i < search->tuples_count; i++) {
+        matches[i] = match_tuple(&search->tuples[i], x, y);
+        if (end - j < 8) {
+          matches[i] &= (1ULL << 8 * (end - j)) - 1;
+        }
+        all |= matches[i];
+      }
+      for ( ; all != 0; all &= all - 1) {
+        uint32 b = lowest_bit(all);
+        uint64 prime = block->low + 30ULL * (j + b / 8) + wheel[b % 8];
+        for (uint32 i = 0; i < search->tuples_count; i++) {
+          if (matches[i] >> b & 1) {
+            add_found(block, prime, i);
+          }
+        }
+      }
+    }
+    return;
+  }
+
+  uint64 previous = 0;
+  uint64 record = 0;
+  block->first = 0;
+  for (uint32 j = 0; j < block->bytes; j += 8) {
+    for (uint64 bits = load_bits(block->sieve + j, block->bytes - j); bits != 0; bits &= bits - 1) {
+      uint32 b = lowest_bit(bits);
+      uint64 prime = block->low + 30ULL * (j + b / 8) + wheel[b % 8];
+      if (block->first == 0) {
+        block->first = prime;
+      } else if (block->mode == MODE_GAP_SEARCH ? prime - previous >= search->min_gap
+                                                : prime - previous > record) {
+        record = prime - previous;
+        add_found(block, previous, prime);
+      }
+      previous = prime;
+    }
+  }
+  block->last = previous;
+}
+
+/*------------------------------------------------------------------------------
+  Hngt das Paar (a, b) an die Fundstellen des Blocks an.
+------------------------------------------------------------------------------*/
+static void add_found(Block* block, uint64 a, uint64 b) {
+  if (block->found_count == block->found_size) {
+    block->found_size = block->found_size < 1024 ? 1024 : 2 * block->found_size;
+    if ((block->found = realloc(block->found, sizeof(uint64) * 2 * block->found_size)) == NULL) {
+      perror("memory error");
+      exit(4);
+    }
+  }
+  block->found[2 * block->found_count] = a;
+  block->found[2 * block->found_count + 1] = b;
+  block->found_count += 1;
+}
+
+/*------------------------------------------------------------------------------
+  Prft, ob x < 121 eine Primzahl ist.
+------------------------------------------------------------------------------*/
+static int is_small_prime(uint64 x) {
+  return    x == 2 || x == 3 || x == 5 || x == 7
+         || (x > 7 && x % 2 != 0 && x % 3 != 0 && x % 5 != 0 && x % 7 != 0);
+}
+
+/*------------------------------------------------------------------------------
+  Siebt einen Block von 30 * bytes Zahlen ab block->low und zhlt die darin
+  enthaltenen Primzahlen >= block->z.
+
+  Der Block wird in Segmente von segment_bytes Bytes zerlegt, die in den Cache
+  passen. Jede Primzahl merkt sich, wo ihr nchstes Vielfaches liegt, und
+  macht dort im nchsten Segment weiter. Nur wenn der Block nicht direkt an
+  den vorigen Block desselben Threads anschliet, werden die Startpositionen
+  neu berechnet.
+
+  Groe Primzahlen (hchstens ein Vielfaches je Segment) werden nicht in
+  jedem Segment angefasst, sondern liegen im Eimer des Segments, in dem ihr
+  nchstes Vielfaches liegt (Bucket-Sieb nach Oliveira e Silva). Mit
+  Speichergrenze werden sie stattdessen nach allen Segmenten im ganzen Block
+  gestrichen (cross_off_large).
+------------------------------------------------------------------------------*/
+static void sieve_block(Block* block) {
+  uint32 segment_bytes = block->segment_bytes;
+
+  if (block->sieving_primes_low != block->low) {
+    init_block(block);
+  }
+
+  for (uint32 s = 0; s < block->bytes; s += segment_bytes) {
+    uint8* sieve = block->sieve + s;
+    uint64 segment_low = block->low + 30ULL * s;
+
+    presieve_segment(block, sieve, segment_low);
+    for (uint32 i = PRESIEVE_NEXT; i < block->large_start; i++) {
+      block->crossings += cross_off(&block->sieving_primes[i], sieve, segment_bytes);
+    }
+    if (block->factor_gaps == NULL) {
+      add_large_sieving_primes(block, segment_low);
+      block->crossings += cross_off_bucket(block, sieve);
+    }
+    block->segment_number += 1;
+  }
+  if (block->factor_gaps != NULL) {
+    block->crossings += cross_off_large(block);
+  }
+  block->sieving_primes_low = block->low + 30ULL * block->bytes;
+
+  /* Zahlen < z und > z_end ausblenden */
+  if (block->z > block->low) {
+    for (uint32 k = 0; k < 8; k++) {
+      if (block->low + wheel[k] < block->z) {
+        block->sieve[0] &= (uint8) ~(1 << k);
+      }
+    }
+  }
+  if (block->z_end < block->low) {
+    memset(block->sieve, 0, block->bytes);
+  } else if (block->z_end - block->low < 30ULL * block->bytes) {
+    uint32 j = (uint32) ((block->z_end - block->low) / 30);
+    for (uint32 k = 0; k < 8; k++) {
+      if (wheel[k] > block->z_end - block->low - 30ULL * j) {
+        block->sieve[j] &= (uint8) ~(1 << k);
+      }
+    }
+    memset(block->sieve + j + 1, 0, block->bytes - j - 1);
+  }
+
+  block->count = block->kernels->count_bits(block->sieve, block->bytes);
+  if (block->mode == MODE_SUM || block->mode == MODE_GAPS) {
+    calc_block_statistics(block);
+  } else if (block->search != NULL) {
+    calc_block_search(block);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Fllt ein Segment ab segment_low mit den Vorsieb-Mustern, also ohne die
+  Vielfachen von 7 bis 29. Sie liegen in jedem Segment an einer anderen
+  Stelle des Musters; die beiden Muster werden stckweise bis zu ihrem Ende
+  miteinander verknpft (and_bytes).
+
+  Im ersten Byte (0 bis 29) sind damit auch 7 bis 29 gestrichen, die selbst
+  Primzahlen sind; es wird wieder gesetzt.
+------------------------------------------------------------------------------*/
+static void presieve_segment(Block* block, uint8* sieve, uint64 segment_low) {
+  const Pattern* a = &block->presieve[0];
+  const Pattern* b = &block->presieve[1];
+  uint32 a_index = (uint32) (segment_low / 30 % a->period);
+  uint32 b_index = (uint32) (segment_low / 30 % b->period);
+
+  for (uint32 j = 0; j < block->segment_bytes; ) {
+    uint32 size = block->segment_bytes - j;
+    if (size > a->period - a_index) {
+      size = a->period - a_index;
+    }
+    if (size > b->period - b_index) {
+      size = b->period - b_index;
+    }
+    block->kernels->and_bytes(sieve + j, a->bytes + a_index, b->bytes + b_index, size);
+    j += size;
+    a_index = a_index + size == a->period ? 0 : a_index + size;
+    b_index = b_index + size == b->period ? 0 : b_index + size;
+  }
+
+  if (segment_low == 0) {
+    sieve[0] = 0xff;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet fr die kleinen Primfaktoren ab 31 (d.h. ab primes[PRESIEVE_NEXT],
+  die kleineren erledigen die Vorsieb-Muster) die Startpositionen im Block
+  und leert die Eimer der groen (ohne Eimer: siehe cross_off_large).
+
+  Gro sind die Primzahlen p ab large_start, deren kleinster Abstand zwischen
+  zwei Vielfachen (2 * (p / 30) Bytes) mindestens ein Segment betrgt. Es
+  werden so viele Eimer angelegt (Zweierpotenz), dass der grte Abstand
+  eines Vielfachen (< 7 * p / 30 + 7 Bytes) innerhalb des Rings bleibt.
+------------------------------------------------------------------------------*/
+static void init_block(Block* block) {
+  for (uint32 i = PRESIEVE_NEXT; i < block->large_start; i++) {
+    init_sieving_prime(&block->sieving_primes[i], block->primes[i], block->low);
+  }
+  block->large_next = block->large_start;
+  if (block->factor_gaps != NULL) {
+    return;
+  }
+
+  if (block->buckets == NULL) {
+    uint64 horizon = (7ULL * block->primes[block->primes_top] / 30 + 7) / block->segment_bytes + 2;
+    uint32 buckets_count = 1;
+    while (buckets_count < horizon) {
+      buckets_count *= 2;
+    }
+    block->buckets_mask = buckets_count - 1;
+    if ((block->buckets = calloc(buckets_count, sizeof(block->buckets[0]))) == NULL) {
+      perror("memory error");
+      exit(4);
+    }
+  }
+  for (uint32 b = 0; b <= block->buckets_mask; b++) {
+    block->buckets[b].count = 0;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet fr eine Primzahl das erste zu streichende Vielfache p * q >= low
+  (und >= p^2) mit q teilerfremd zu 30.
+
+  Liegt es jenseits von 2^64, wird index = NEVER gesetzt.
+------------------------------------------------------------------------------*/
+static void init_sieving_prime(SievingPrime* sieving_prime, uint32 prime, uint64 low) {
+  uint64 p = prime;
+  uint64 q = low / p + (low % p != 0);
+  if (q < p) {
+    q = p;
+  }
+  uint32 k = wheel_next[q % 30];
+  q += wheel[k] - q % 30;
+
+  sieving_prime->index = q > ~0ULL / p ? NEVER : (p * q - low) / 30;
+  sieving_prime->factor = (uint32) (p / 30);
+  sieving_prime->rest = wheel_bit[p % 30];
+  sieving_prime->wheel_index = (uint8) k;
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt die groen Primzahlen, deren Quadrat vor dem Ende des Segments ab
+  segment_low liegt, in die Eimer auf.
+
+  Da die Primzahlen erst dann dazukommen, bleibt das erste Vielfache immer
+  innerhalb des Rings der Eimer.
+------------------------------------------------------------------------------*/
+static void add_large_sieving_primes(Block* block, uint64 segment_low) {
+  uint64 segment_high = segment_low + 30ULL * block->segment_bytes;
+  if (segment_high < segment_low) {
+    segment_high = ~0ULL;
+  }
+
+  while (   block->large_next <= block->primes_top
+         && (uint64) block->primes[block->large_next] * block->primes[block->large_next]
+              < segment_high) {
+    SievingPrime sieving_prime;
+    init_sieving_prime(&sieving_prime, block->primes[block->large_next], segment_low);
+    if (sieving_prime.index != NEVER) {
+      push_bucket(block, block->segment_number, sieving_prime);
+    }
+    block->large_next += 1;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Streicht die Vielfachen aller groen Primzahlen im Eimer des aktuellen
+  Segments und verteilt sie auf die Eimer ihrer nchsten Vielfachen.
+  Zurckgegeben wird die Anzahl der gestrichenen Vielfachen.
+------------------------------------------------------------------------------*/
+static uint32 cross_off_bucket(Block* block, uint8* sieve) {
+  Bucket* bucket = &block->buckets[block->segment_number & block->buckets_mask];
+  uint32 crossings = 0;
+
+  for (uint32 e = 0; e < bucket->count; e++) {
+    SievingPrime sieving_prime = bucket->entries[e];
+    crossings += cross_off(&sieving_prime, sieve, block->segment_bytes);
+    push_bucket(block, block->segment_number + 1, sieving_prime);
+  }
+  bucket->count = 0;
+  return crossings;
+}
+
+/*------------------------------------------------------------------------------
+  Streicht die Vielfachen aller groen Primzahlen im ganzen Block, ohne Eimer:
+  das erste Vielfache im Block wird fr jede neu berechnet. Die groen stehen
+  ab large_start in primes und danach als halbe Abstnde in factor_gaps.
+  Zurckgegeben wird die Anzahl der gestrichenen Vielfachen.
+
+  Das kostet je Block eine Division je Primzahl bis zur Wurzel, aber nur ein
+  Byte statt eines Eintrags im Eimer je Primzahl; build_blocks macht die
+  Blcke dafr so gro wie mglich.
+------------------------------------------------------------------------------*/
+static uint64 cross_off_large(Block* block) {
+  uint64 high = block->low + 30ULL * block->bytes;
+  if (high < block->low) {
+    high = ~0ULL;
+  }
+  uint64 crossings = 0;
+
+  for (uint32 i = block->large_start; i <= block->primes_top; i++) {
+    if ((uint64) block->primes[i] * block->primes[i] >= high) {
+      return crossings;
+    }
+    crossings += cross_off_block(block, block->primes[i]);
+  }
+  uint64 p = block->primes[block->primes_top];
+  for (uint64 g = 0; g < block->factor_gaps_count; g++) {
+    p += 2ULL * block->factor_gaps[g];
+    if (p * p >= high) {
+      break;
+    }
+    crossings += cross_off_block(block, (uint32) p);
+  }
+  return crossings;
+}
+
+/*------------------------------------------------------------------------------
+  Streicht alle Vielfachen einer Primzahl im ganzen Block.
+------------------------------------------------------------------------------*/
+static uint32 cross_off_block(Block* block, uint32 prime) {
+  SievingPrime sieving_prime;
+  init_sieving_prime(&sieving_prime, prime, block->low);
+  if (sieving_prime.index == NEVER) {
+    return 0;
+  }
+  return cross_off(&sieving_prime, block->sieve, block->bytes);
+}
+
+/*------------------------------------------------------------------------------
+  Legt eine Primzahl, deren index sich auf das Segment segment_number bezieht,
+  in den Eimer des Segments, in dem ihr nchstes Vielfaches liegt.
+------------------------------------------------------------------------------*/
+static void push_bucket(Block* block, uint64 segment_number, SievingPrime sieving_prime) {
+  segment_number += sieving_prime.index / block->segment_bytes;
+  sieving_prime.index %= block->segment_bytes;
+
+  Bucket* bucket = &block->buckets[segment_number & block->buckets_mask];
+  if (bucket->count == bucket->capacity) {
+    bucket->capacity = bucket->capacity == 0 ? 64 : 2 * bucket->capacity;
+    bucket->entries = realloc(bucket->entries, sizeof(bucket->entries[0]) * bucket->capacity);
+    if (bucket->entries == NULL) {
+      perror("memory error");
+      exit(4);
+    }
+  }
+  bucket->entries[bucket->count++] = sieving_prime;
+}
+
+/*------------------------------------------------------------------------------
+  Streicht alle Vielfachen einer Primzahl in einem Segment von bytes Bytes.
+
+  Fr p = 30 * a + r und q = 30 * b + wheel[k] liegt p * q im Byte
+  p * b + a * wheel[k] + r * wheel[k] / 30. Der Abstand zum nchsten
+  Vielfachen (q mit dem nchsten Rest wheel[k + 1]) ist daher
+  a * wheel_gap[k] + wheel_carry[r][k] Bytes.
+
+  Nach 8 Vielfachen (q + 30) ist man genau p Bytes weiter. Solange ein ganzer
+  Umlauf ins Segment passt, werden daher die 8 Abstnde und Masken einmal
+  berechnet und die Vielfachen in einer ausgerollten Schleife gestrichen.
+
+  Danach zeigt index auf das nchste Vielfache relativ zum folgenden Segment.
+  Zurckgegeben wird die Anzahl der gestrichenen Vielfachen.
+------------------------------------------------------------------------------*/
+static uint32 cross_off(SievingPrime* sieving_prime, uint8* sieve, uint32 bytes) {
+  uint64 j = sieving_prime->index;
+  uint32 a = sieving_prime->factor;
+  uint32 r = sieving_prime->rest;
+  uint32 k = sieving_prime->wheel_index;
+  uint32 p = 30 * a + wheel[r];
+  uint32 crossings = 0;
+
+  if (p < bytes && j < bytes - p) {
+    uint32 offsets[8];
+    uint8  masks[8];
+    uint32 offset = 0;
+    for (uint32 i = 0; i < 8; i++) {
+      uint32 ki = (k + i) & 7;
+      offsets[i] = offset;
+      masks[i] = wheel_mask[r][ki];
+      offset += a * wheel_gap[ki] + wheel_carry[r][ki];
+    }
+    uint32 o1 = offsets[1], o2 = offsets[2], o3 = offsets[3];
+    uint32 o4 = offsets[4], o5 = offsets[5], o6 = offsets[6], o7 = offsets[7];
+    uint8 m0 = masks[0], m1 = masks[1], m2 = masks[2], m3 = masks[3];
+    uint8 m4 = masks[4], m5 = masks[5], m6 = masks[6], m7 = masks[7];
+    uint8* s = sieve + j;
+    uint8* end = sieve + bytes - p;
+    while (s < end) {
+      s[0]  &= m0;
+      s[o1] &= m1;
+      s[o2] &= m2;
+      s[o3] &= m3;
+      s[o4] &= m4;
+      s[o5] &= m5;
+      s[o6] &= m6;
+      s[o7] &= m7;
+      s += p;
+    }
+    crossings = (uint32) ((uint64) (s - sieve - j) / p * 8);
+    j = (uint64) (s - sieve);
+  }
+
+  while (j < bytes) {
+    sieve[j] &= wheel_mask[r][k];
+    j += a * wheel_gap[k] + wheel_carry[r][k];
+    k = (k + 1) & 7;
+    crossings += 1;
+  }
+  sieving_prime->index = j - bytes;
+  sieving_prime->wheel_index = (uint8) k;
+  return crossings;
+}
+
+/*------------------------------------------------------------------------------
+  Startet einen Thread, der sieve_block(block) ausfhrt.
+------------------------------------------------------------------------------*/
+#ifdef _WIN32
+static DWORD WINAPI block_thread(LPVOID block) {
+  sieve_block(block);
+  return 0;
+}
+
+static Thread start_block_thread(Block* block) {
+  Thread thread = CreateThread(NULL, 0, block_thread, block, 0, NULL);
+  if (thread == NULL) {
+    fprintf(stderr, "thread error\n");
+    exit(6);
+  }
+  return thread;
+}
+#else
+static void* block_thread(void* block) {
+  sieve_block(block);
+  return NULL;
+}
+
+static Thread start_block_thread(Block* block) {
+  Thread thread;
+  if (pthread_create(&thread, NULL, block_thread, block) != 0) {
+    perror("thread error");
+    exit(6);
+  }
+  return thread;
+}
+#endif
+
+/*------------------------------------------------------------------------------
+  Wartet auf das Ende eines Threads.
+------------------------------------------------------------------------------*/
+static void join_block_thread(Thread thread) {
+#ifdef _WIN32
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+#else
+  pthread_join(thread, NULL);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+  Siebt das Fenster [low, high] des Iterators und merkt sich dessen
+  Primzahlen.
+
+  Die Primfaktoren ber ITERATOR_WINDOW treffen ein Fenster hchstens
+  einmal, Eimer lohnen sich fr sie nicht. Sie stehen darum auch ohne
+  Speichergrenze nur als Abstnde (nahe 2^64 etwa 200 MB statt 800 MB).
+------------------------------------------------------------------------------*/
+static void sieve_window(NthPrimeIterator* iterator, uint64 low, uint64 high) {
+  Query query = make_query(&iterator->context, MODE_PRIMES, 1, append_prime, iterator);
+  if (iterator->factors.primes == NULL || high > iterator->factors_limit) {
+    free_prime_factors(&iterator->factors);
+    iterator->factors_limit = high > ~0ULL / 4 ? ~0ULL : 4 * high;
+    uint64 dense_limit = calc_dense_limit(&query, iterator->factors_limit);
+    uint64 window_limit = 30ULL * ((query.segment_bytes + 1) / 2);   /* siehe calc_dense_limit */
+    if (window_limit < ITERATOR_WINDOW) {
+      window_limit = ITERATOR_WINDOW;
+    }
+    build_prime_factors(iterator->factors_limit,
+                        dense_limit < window_limit ? dense_limit : window_limit,
+                        &iterator->factors);
+  }
+
+  iterator->low = low;
+  iterator->high = high;
+  iterator->count = 0;
+  calc_primes_between(&query, low, high, &iterator->factors);
+  finish_query(&query);
+}
+
+/*------------------------------------------------------------------------------
+  Sucht (binr) den Index der ersten Primzahl >= x im Fenster des Iterators
+  (count, wenn es keine gibt).
+------------------------------------------------------------------------------*/
+static uint64 find_prime(NthPrimeIterator* iterator, uint64 x) {
+  uint64 left = 0;
+  uint64 right = iterator->count;
+  while (left < right) {
+    uint64 middle = left + (right - left) / 2;
+    if (iterator->primes[middle] < x) {
+      left = middle + 1;
+    } else {
+      right = middle;
+    }
+  }
+  return left;
+}
+
+/*------------------------------------------------------------------------------
+  Setzt den Iterator auf eine gelieferte Primzahl und gibt sie zurck.
+------------------------------------------------------------------------------*/
+static uint64 move_iterator(NthPrimeIterator* iterator, uint64 prime) {
+  iterator->next_from = prime + 1;
+  iterator->prev_below = prime;
+  return prime;
+}
+
+/*------------------------------------------------------------------------------
+  Ermittelt den (ungeraden) Anfang z eines kurzen Fensters knapp unterhalb der
+  n-ten Primzahl, ab dem gesiebt wird (n ist die erste auszugebende Nummer),
+  und in count_primes die Anzahl der Primzahlen < z. Beim Aufruf enthlt
+  count_primes die Anzahl fr den frhesten Anfang direkt hinter der grten
+  einzeln gespeicherten Primzahl in factors.
+
+  Liegt ein Checkpoint (aus der Datei oder pi_table) nahe genug unter der
+  n-ten Primzahl, beginnt das Fenster direkt dahinter. Sonst (ab PI_ENGINE_MIN_N) gilt:
+
+  Fr x < 10^19 gilt pi(x) < li(x), also liegt inverse_li(n) unterhalb der
+  n-ten Primzahl, und zwar nur um eine Grenordnung von sqrt(x).
+  Zur Sicherheit gegen Rundungsfehler wird noch etwas abgezogen und das
+  Ergebnis mit pi(x) berprft. Unter die untere Schranke inverse_pi_lower(n)
+  muss dabei nie gegangen werden. Mit einer Checkpoint-Datei wird x auf ein
+  Vielfaches von CHECKPOINT_STRIDE abgerundet und gespeichert. Mit
+  Speichergrenze geht x nicht ber calc_pi_limit hinaus.
+------------------------------------------------------------------------------*/
+static uint64 calc_window_start(Query* query, uint64 n, const Factors* factors, uint64* count_primes) {
+  uint64 z_min = 2ULL + factors->primes[factors->primes_top];
+  uint64 delta = factors->sqrt_x;
+  uint64 pi_limit = calc_pi_limit(query);
+  uint64 x = inverse_li(n);
+  uint64 x_min = inverse_pi_lower(n);   /* pi(x) < n fr alle x < x_min */
+  uint64 granularity = query->checkpoints != NULL ? CHECKPOINT_STRIDE : 2;
+  Checkpoint checkpoint;
+
+  if (   find_known_pi(query, ~0ULL, n, &checkpoint)
+      && checkpoint.x + 1 >= z_min
+      && prefer_sieve(x > checkpoint.x ? x - checkpoint.x : 0, x)) {
+    *count_primes = checkpoint.pi;
+    return checkpoint.x + 1;
+  }
+  if (n < PI_ENGINE_MIN_N) {
+    return z_min;
+  }
+
+  while (1) {
+    if (x < z_min + delta) {
+      return z_min;
+    }
+    x -= delta;
+    if (x < x_min) {
+      x = x_min - 1;
+    }
+    if (x > pi_limit) {
+      x = pi_limit;
+    }
+    x -= x % granularity;
+    if (x + 1 < z_min) {
+      return z_min;
+    }
+    double start = get_seconds();
+    uint64 pi = prime_pi(query, x);
+    add_timing(query, PHASE_BOUND, start);
+    if (pi < n) {
+      if (query->checkpoints != NULL) {
+        add_checkpoint(query->checkpoints, x, pi);
+      }
+      *count_primes = pi;
+      return x + 1;
+    }
+    delta *= 2;
+  }
+}
+
+/*==============================================================================
+  Inkrementelles Sieb (das Verfahren von nth-prime-alternative-1)
+==============================================================================*/
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen von der n_start-ten bis zur n-ten mit dem
+  inkrementellen Sieb. Zurckgegeben wird -1, wenn die n-te Primzahl nicht
+  < 2^64 ist, sonst 0.
+
+  Gesiebt wird ab dem grten Checkpoint (aus der Datei oder pi_table) vor
+  der n_start-ten Primzahl, sonst ab 3.
+------------------------------------------------------------------------------*/
+static int generate_primes(Query* query, uint64 n) {
+  if (inverse_pi(n) == 0) {
+    return -1;
+  }
+
+  uint64 count_primes = 1;
+  uint64 start = 3;
+  Checkpoint checkpoint;
+  if (   find_known_pi(query, ~0ULL, query->n_start, &checkpoint)
+      && checkpoint.x >= 3) {
+    count_primes = checkpoint.pi;
+    start = checkpoint.x + 1;
+  } else if (report_prime(query, 1, 2) || n == 1) {
+    return 0;
+  }
+
+  double started = get_seconds();
+  uint64 count_start = count_primes;
+  query->phase_started = started;
+  Generator* generator = create_generator(start);
+  while (count_primes < n) {
+    uint64 prime = generate_prime(generator);
+    count_primes += 1;
+    if (report_prime(query, count_primes, prime)) {
+      break;
+    }
+    if ((count_primes & (PROGRESS_PRIMES - 1)) == 0) {
+      report_progress(query, NTHPRIME_PHASE_SIEVE,
+                      (double) (count_primes - count_start) / (double) (n - count_start),
+                      prime, prime - start + 1, count_primes);
+    }
+  }
+  destroy_generator(generator);
+  add_timing(query, PHASE_SEGMENTS, started);
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Meldet alle Primzahlen in [a, b] mit dem inkrementellen Sieb, gezhlt ab
+  der ersten >= a.
+------------------------------------------------------------------------------*/
+static void generate_primes_between(Query* query, uint64 a, uint64 b) {
+  uint64 count_primes = 0;
+  query->checkpoints = NULL;   /* die Nummern zhlen erst ab a */
+
+  if (a <= 2 && b >= 2) {
+    count_primes += 1;
+    if (report_prime(query, count_primes, 2)) {
+      return;
+    }
+  }
+
+  double started = get_seconds();
+  query->phase_started = started;
+  Generator* generator = create_generator(a < 3 ? 3 : a);
+  for (uint64 prime = generate_prime(generator); prime != 0 && prime <= b;
+       prime = generate_prime(generator)) {
+    count_primes += 1;
+    if (report_prime(query, count_primes, prime)) {
+      break;
+    }
+    if ((count_primes & (PROGRESS_PRIMES - 1)) == 0) {
+      report_progress(query, NTHPRIME_PHASE_SIEVE, (double) (prime - a) / (double) (b - a),
+                      prime, prime - a + 1, count_primes);
+    }
+  }
+  destroy_generator(generator);
+  add_timing(query, PHASE_SEGMENTS, started);
+}
+
+/*------------------------------------------------------------------------------
+  Legt einen Generator an, der zuerst die kleinste ungerade Primzahl >= start
+  liefert (start >= 3).
+
+  Die Primzahlen p mit p^2 < start kommen dabei gleich mit ihrem ersten
+  ungeraden Vielfachen >= start in den Ring.
+------------------------------------------------------------------------------*/
+static Generator* create_generator(uint64 start) {
+  Generator* generator;
+  if ((generator = malloc(sizeof(*generator))) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  generator->number = (start | 1) - 2;
+  generator->i = 0;
+  generator->ring_mask = MIN_RING_SIZE - 1;
+  generator->ring = build_ring(MIN_RING_SIZE);
+  generator->next_base = 3;
+  generator->next_square = 9;
+  generator->base = NULL;
+
+  while (generator->next_square != 0 && generator->next_square <= generator->number) {
+    uint64 p = generator->next_base;
+    uint64 multiple = (generator->number + 2 + p - 1) / p * p;
+    add_base_prime(generator, multiple % 2 == 0 ? multiple + p : multiple);
+  }
+  return generator;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt einen Generator mit allen, die seine Primfaktoren liefern, frei.
+------------------------------------------------------------------------------*/
+static void destroy_generator(Generator* generator) {
+  while (generator != NULL) {
+    Generator* base = generator->base;
+    free(generator->ring);
+    free(generator);
+    generator = base;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet mit dem Algorithmus des Eratosthenes die nchste Primzahl
+  (0: keine mehr < 2^64).
+
+  Der Ring hat einen Platz je ungerade Zahl ab number. In einem Platz steht
+  ein Primfaktor p, wenn die Zahl dort ein Vielfaches von p ist. Ist die Zahl
+  erreicht, wandert p um 2p weiter (ist der Platz dort belegt, bleibt der
+  grere Faktor stehen und der kleinere wandert weiter).
+
+  Eine Primzahl p kommt erst in den Ring, wenn number ihr Quadrat erreicht.
+  Die Primzahlen dafr liefert ein zweiter Generator (base), der nur bis zur
+  Wurzel von number laufen muss und erst bei Bedarf angelegt wird. Der Ring
+  wchst so mit der Wurzel von number.
+------------------------------------------------------------------------------*/
+static uint64 generate_prime(Generator* generator) {
+  uint64 number = generator->number;
+  uint64 i = generator->i;
+  uint64 ring_mask = generator->ring_mask;
+  uint32* ring = generator->ring;
+
+  do {
+    if (number >= ~0ULL - 2) {
+      return 0;
+    }
+    number += 2;
+    i = (i + 1) & ring_mask;
+
+    if (number == generator->next_square) {
+      generator->number = number;
+      generator->i = i;
+      add_base_prime(generator, number + 2ULL * generator->next_base);
+      ring_mask = generator->ring_mask;
+      ring = generator->ring;
+      continue;
+    }
+    if (ring[i] == 0) {
+      break;
+    }
+    uint32 factor = ring[i];
+    ring[i] = 0;
+    move_factor(generator, i, factor);
+  } while (1);
+
+  generator->number = number;
+  generator->i = i;
+  return number;
+}
+
+/*------------------------------------------------------------------------------
+  Nimmt next_base mit dem ungeraden Vielfachen multiple (> number) in den
+  Ring auf und holt die nchste Primzahl vom Generator base.
+
+  Der Ring wird vorher so weit vergrert, dass er mindestens 2 * next_base
+  Pltze hat; so weit kann ein Faktor hchstens vorauslaufen.
+------------------------------------------------------------------------------*/
+static void add_base_prime(Generator* generator, uint64 multiple) {
+  uint32 p = generator->next_base;
+  if (generator->ring_mask < 2ULL * p) {
+    uint64 size = generator->ring_mask + 1;
+    while (size <= 2ULL * p) {
+      size *= 2;
+    }
+    grow_ring(generator, size);
+  }
+  move_factor(generator, generator->i + (multiple - generator->number) / 2 - p, p);
+
+  if (generator->base == NULL) {
+    generator->base = create_generator(p + 2ULL);
+  }
+  uint64 q = generate_prime(generator->base);
+  generator->next_base = (uint32) q;
+  generator->next_square = q == 0 || q > 0xffffffffULL ? 0 : q * q;
+}
+
+/*------------------------------------------------------------------------------
+  Setzt factor vom Platz j aus auf den nchsten freien Platz j + k * factor
+  (k >= 1). Ist ein Platz mit einem kleineren Faktor belegt, werden die
+  beiden getauscht.
+------------------------------------------------------------------------------*/
+static void move_factor(Generator* generator, uint64 j, uint32 factor) {
+  uint64 ring_mask = generator->ring_mask;
+  uint32* ring = generator->ring;
+  do {
+    j = (j + factor) & ring_mask;
+    if (ring[j] == 0) {
+      break;
+    }
+    if (ring[j] < factor) {
+      uint32 smaller_factor = ring[j];
+      ring[j] = factor;
+      factor = smaller_factor;
+    }
+  } while (1);
+  ring[j] = factor;
+}
+
+/*------------------------------------------------------------------------------
+  Vergrert den Ring auf size Pltze (Potenz von 2). Jeder Faktor behlt
+  seinen Abstand zu number.
+------------------------------------------------------------------------------*/
+static void grow_ring(Generator* generator, uint64 size) {
+  uint32* ring = build_ring(size);
+  for (uint64 d = 0; d <= generator->ring_mask; d++) {
+    ring[(generator->i + d) & (size - 1)] = generator->ring[(generator->i + d) & generator->ring_mask];
+  }
+  free(generator->ring);
+  generator->ring = ring;
+  generator->ring_mask = size - 1;
+}
+
+/*------------------------------------------------------------------------------
+  Baut einen Ring mit size Pltzen auf, der mit Nullen initialisiert ist.
+------------------------------------------------------------------------------*/
+static uint32* build_ring(uint64 size) {
+  uint32* ring;
+  if ((ring = calloc((size_t) size, sizeof(ring[0]))) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+  return ring;
+}
+
+/*==============================================================================
+  Checkpoints
+==============================================================================*/
+
+/*------------------------------------------------------------------------------
+  ffnet (oder erzeugt) eine Checkpoint-Datei.
+
+  Sie beginnt mit CHECKPOINT_MAGIC, danach folgen die Checkpoints (x, pi(x))
+  als je zwei 64-Bit-Zahlen in der Byte-Reihenfolge des Rechners. Neue
+  Checkpoints werden angehngt (append_checkpoint), ein unvollstndiger am
+  Ende wird dabei berschrieben.
+
+  Zurckgegeben wird NULL, wenn die Datei nicht gelesen oder geschrieben
+  werden kann oder keine (unbeschdigte) Checkpoint-Datei ist, siehe
+  check_checkpoints; dann ist errno EINVAL.
+------------------------------------------------------------------------------*/
+static Checkpoints* open_checkpoints(const char* path) {
+  Checkpoints* checkpoints;
+  if ((checkpoints = calloc(1, sizeof(*checkpoints))) == NULL) {
+    perror("memory error");
+    exit(4);
+  }
+
+  FILE* file = fopen(path, "r+b");
+  if (file == NULL && errno == ENOENT && (file = fopen(path, "w+b")) != NULL) {
+    if (fwrite(CHECKPOINT_MAGIC, 1, CHECKPOINT_HEADER, file) != CHECKPOINT_HEADER) {
+      fclose(file);
+      file = NULL;
+    }
+  }
+  if (file == NULL) {
+    free(checkpoints);
+    return NULL;
+  }
+  checkpoints->file = file;
+
+  char magic[CHECKPOINT_HEADER];
+  long size;
+  if (   fseek(file, 0, SEEK_END) != 0
+      || (size = ftell(file)) < CHECKPOINT_HEADER
+      || fseek(file, 0, SEEK_SET) != 0
+      || fread(magic, 1, CHECKPOINT_HEADER, file) != CHECKPOINT_HEADER
+      || memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_HEADER) != 0) {
+    fclose(file);
+    free(checkpoints);
+    errno = EINVAL;
+    return NULL;
+  }
+
+#ifdef _WIN32
+  InitializeCriticalSection(&checkpoints->mutex);
+#else
+  pthread_mutex_init(&checkpoints->mutex, NULL);
+#endif
+  uint64 count = (uint64) (size - CHECKPOINT_HEADER) / sizeof(Checkpoint);
+  if (count > 0 && map_checkpoints(checkpoints, count) != 0) {
+    int error = errno;
+    close_checkpoints(checkpoints);
+    errno = error;
+    return NULL;
+  }
+  if (check_checkpoints(checkpoints) != 0) {
+    close_checkpoints(checkpoints);
+    errno = EINVAL;
+    return NULL;
+  }
+  return checkpoints;
+}
+
+/*------------------------------------------------------------------------------
+  Bildet die count Checkpoints der Datei im Speicher ab (mmap).
+
+  Der nach x sortierte Anfang wird direkt aus der Abbildung gelesen. Nur der
+  Rest (aus Lufen, die nicht hinter den bisherigen Checkpoints angefangen
+  haben) wird sortiert nach added kopiert. Steht dabei ein x zweimal mit
+  verschiedenem pi in der Datei, wird -1 zurckgegeben (errno EINVAL).
+------------------------------------------------------------------------------*/
+static int map_checkpoints(Checkpoints* checkpoints, uint64 count) {
+  size_t size = (size_t) (CHECKPOINT_HEADER + count * sizeof(Checkpoint));
+#ifdef _WIN32
+  HANDLE file = (HANDLE) _get_osfhandle(_fileno(checkpoints->file));
+  HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  void* map = mapping == NULL ? NULL : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+  if (map == NULL) {
+    if (mapping != NULL) {
+      CloseHandle(mapping);
+    }
+    return -1;
+  }
+  checkpoints->mapping = mapping;
+#else
+  void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(checkpoints->file), 0);
+  if (map == MAP_FAILED) {
+    return -1;
+  }
+#endif
+  checkpoints->map = map;
+  checkpoints->map_size = size;
+
+  const Checkpoint* entries = (const Checkpoint*) ((char*) map + CHECKPOINT_HEADER);
+  uint64 sorted = 1;
+  while (sorted < count && entries[sorted].x > entries[sorted - 1].x) {
+    sorted += 1;
+  }
+  checkpoints->mapped = entries;
+  checkpoints->mapped_count = sorted;
+  for (uint64 i = sorted; i < count; i++) {
+    if (insert_checkpoint(checkpoints, entries[i]) < 0) {
+      errno = EINVAL;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Schliet eine Checkpoint-Datei.
+------------------------------------------------------------------------------*/
+static void close_checkpoints(Checkpoints* checkpoints) {
+#ifdef _WIN32
+  if (checkpoints->map != NULL) {
+    UnmapViewOfFile(checkpoints->map);
+    CloseHandle(checkpoints->mapping);
+  }
+  DeleteCriticalSection(&checkpoints->mutex);
+#else
+  if (checkpoints->map != NULL) {
+    munmap(checkpoints->map, (size_t) checkpoints->map_size);
+  }
+  pthread_mutex_destroy(&checkpoints->mutex);
+#endif
+  fclose(checkpoints->file);
+  free(checkpoints->added);
+  free(checkpoints);
+}
+
+/*------------------------------------------------------------------------------
+  Prft die Checkpoints einer gerade geffneten Datei, damit eine
+  abgeschnittene oder beschdigte Datei keine falschen Ergebnisse liefert:
+  jeder muss fr sich plausibel sein (is_plausible_checkpoint), und nach x
+  sortiert muss pi streng wachsen, denn zwischen zwei Vielfachen von
+  CHECKPOINT_STRIDE liegt immer eine Primzahl.
+
+  Zurckgegeben wird -1, wenn einer nicht passt, sonst 0.
+------------------------------------------------------------------------------*/
+static int check_checkpoints(const Checkpoints* checkpoints) {
+  uint64 i = 0;
+  uint64 j = 0;
+  uint64 previous_pi = 0;
+  while (i < checkpoints->mapped_count || j < checkpoints->added_count) {
+    Checkpoint checkpoint;
+    if (   j == checkpoints->added_count
+        || (i < checkpoints->mapped_count && checkpoints->mapped[i].x < checkpoints->added[j].x)) {
+      checkpoint = checkpoints->mapped[i++];
+    } else {
+      checkpoint = checkpoints->added[j++];
+    }
+    if (is_plausible_checkpoint(checkpoint) == 0 || checkpoint.pi <= previous_pi) {
+      return -1;
+    }
+    previous_pi = checkpoint.pi;
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Prft, ob x ein Vielfaches von CHECKPOINT_STRIDE ist und pi zu x passt:
+  im Bereich von pi_table genau bzw. streng zwischen den beiden Nachbarn,
+  darber muss x zwischen den Schranken fr die pi-te und die (pi+1)-te
+  Primzahl liegen (inverse_pi_lower und inverse_pi).
+------------------------------------------------------------------------------*/
+static int is_plausible_checkpoint(Checkpoint checkpoint) {
+  if (   checkpoint.x == 0 || checkpoint.x % CHECKPOINT_STRIDE != 0
+      || checkpoint.pi == 0 || checkpoint.pi >= MAX_PI_N) {
+    return 0;
+  }
+  uint64 k = checkpoint.x / PI_TABLE_STRIDE;
+  if (k + 1 < PI_TABLE_SIZE) {
+    if (checkpoint.x % PI_TABLE_STRIDE == 0) {
+      return checkpoint.pi == pi_table[k];
+    }
+    return pi_table[k] < checkpoint.pi && checkpoint.pi < pi_table[k + 1];
+  }
+  uint64 upper = inverse_pi(checkpoint.pi + 1);
+  return inverse_pi_lower(checkpoint.pi) <= checkpoint.x && (upper == 0 || checkpoint.x < upper);
+}
+
+/*------------------------------------------------------------------------------
+  Sucht den grten Checkpoint mit x' <= x und pi(x') < n.
+  Zurckgegeben wird, ob es einen gibt.
+
+  Da pi mit x wchst, ist die Bedingung fr einen Anfang jedes sortierten
+  Arrays erfllt, also gengt jeweils eine binre Suche.
+------------------------------------------------------------------------------*/
+static int find_checkpoint(Checkpoints* checkpoints, uint64 x, uint64 n, Checkpoint* found) {
+  int is_found = 0;
+
+  lock_checkpoints(checkpoints);
+  for (uint32 a = 0; a < 2; a++) {
+    const Checkpoint* entries = a == 0 ? checkpoints->mapped : checkpoints->added;
+    uint64 left = 0;
+    uint64 right = a == 0 ? checkpoints->mapped_count : checkpoints->added_count;
+    while (left < right) {
+      uint64 middle = left + (right - left) / 2;
+      if (entries[middle].x <= x && entries[middle].pi < n) {
+        left = middle + 1;
+      } else {
+        right = middle;
+      }
+    }
+    if (left > 0 && (is_found == 0 || entries[left - 1].x > found->x)) {
+      *found = entries[left - 1];
+      is_found = 1;
+    }
+  }
+  unlock_checkpoints(checkpoints);
+  return is_found;
+}
+
+/*------------------------------------------------------------------------------
+  Sucht wie find_checkpoint den grten Wert in pi_table mit x' <= x und
+  pi(x') < n. pi(0) = 0 zhlt dabei nicht.
+------------------------------------------------------------------------------*/
+static int find_table_checkpoint(uint64 x, uint64 n, Checkpoint* found) {
+  uint64 left = 0;
+  uint64 right = x / PI_TABLE_STRIDE < PI_TABLE_SIZE ? x / PI_TABLE_STRIDE + 1 : PI_TABLE_SIZE;
+  while (left < right) {
+    uint64 middle = left + (right - left) / 2;
+    if (pi_table[middle] < n) {
+      left = middle + 1;
+    } else {
+      right = middle;
+    }
+  }
+  if (left < 2) {
+    return 0;
+  }
+  found->x = (left - 1) * PI_TABLE_STRIDE;
+  found->pi = pi_table[left - 1];
+  return 1;
+}
+
+/*------------------------------------------------------------------------------
+  Sucht wie find_checkpoint den grten bekannten Wert von pi, in der
+  Checkpoint-Datei (falls es eine gibt) und in pi_table.
+------------------------------------------------------------------------------*/
+static int find_known_pi(const Query* query, uint64 x, uint64 n, Checkpoint* found) {
+  Checkpoint checkpoint;
+  int is_found = find_table_checkpoint(x, n, found);
+  if (   query->checkpoints != NULL
+      && find_checkpoint(query->checkpoints, x, n, &checkpoint)
+      && (is_found == 0 || checkpoint.x > found->x)) {
+    *found = checkpoint;
+    is_found = 1;
+  }
+  return is_found;
+}
+
+/*------------------------------------------------------------------------------
+  Speichert einen neuen Checkpoint und hngt ihn an die Datei an.
+
+  Die Datei ist nur ein Cache: Fehler beim Schreiben werden ignoriert.
+------------------------------------------------------------------------------*/
+static void add_checkpoint(Checkpoints* checkpoints, uint64 x, uint64 pi) {
+  Checkpoint checkpoint;
+  checkpoint.x = x;
+  checkpoint.pi = pi;
+
+  lock_checkpoints(checkpoints);
+  if (insert_checkpoint(checkpoints, checkpoint) > 0) {
+    append_checkpoint(checkpoints, checkpoint);
+  }
+  unlock_checkpoints(checkpoints);
+}
+
+/*------------------------------------------------------------------------------
+  Fgt einen Checkpoint sortiert in added ein, wenn es fr x noch keinen gibt.
+  Zurckgegeben wird 1, wenn er neu ist, 0, wenn es ihn schon gibt, und -1,
+  wenn es fr x schon einen mit anderem pi gibt.
+------------------------------------------------------------------------------*/
+static int insert_checkpoint(Checkpoints* checkpoints, Checkpoint checkpoint) {
+  uint64 i = find_checkpoint_index(checkpoints->mapped, checkpoints->mapped_count, checkpoint.x);
+  if (i < checkpoints->mapped_count && checkpoints->mapped[i].x == checkpoint.x) {
+    return checkpoints->mapped[i].pi == checkpoint.pi ? 0 : -1;
+  }
+  i = find_checkpoint_index(checkpoints->added, checkpoints->added_count, checkpoint.x);
+  if (i < checkpoints->added_count && checkpoints->added[i].x == checkpoint.x) {
+    return checkpoints->added[i].pi == checkpoint.pi ? 0 : -1;
+  }
+
+  if (checkpoints->added_count == checkpoints->added_capacity) {
+    checkpoints->added_capacity = checkpoints->added_capacity == 0 ? 256 : 2 * checkpoints->added_capacity;
+    checkpoints->added = realloc(checkpoints->added,
+                                 sizeof(checkpoints->added[0]) * checkpoints->added_capacity);
+    if (checkpoints->added == NULL) {
+      perror("memory error");
+      exit(4);
+    }
+  }
+  memmove(checkpoints->added + i + 1, checkpoints->added + i,
+          sizeof(checkpoints->added[0]) * (checkpoints->added_count - i));
+  checkpoints->added[i] = checkpoint;
+  checkpoints->added_count += 1;
+  return 1;
+}
+
+/*------------------------------------------------------------------------------
+  Hngt einen Checkpoint an die Datei an.
+
+  Mehrere Prozesse knnen dieselbe Datei benutzen: das Ende wird erst unter
+  einer Sperre der Datei bestimmt, so berschreibt keiner die Checkpoints
+  eines anderen. Gesperrt wird das Byte CHECKPOINT_LOCK hinter dem Ende
+  jeder echten Datei, weil LockFileEx unter Windows auch das Lesen sperrt.
+------------------------------------------------------------------------------*/
+static void append_checkpoint(Checkpoints* checkpoints, Checkpoint checkpoint) {
+  FILE* file = checkpoints->file;
+  if (lock_checkpoint_file(file, 1) != 0) {
+    return;
+  }
+  long size;
+  if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= CHECKPOINT_HEADER) {
+    size -= (long) ((size - CHECKPOINT_HEADER) % sizeof(Checkpoint));
+    if (fseek(file, size, SEEK_SET) == 0) {
+      fwrite(&checkpoint, sizeof(checkpoint), 1, file);
+      fflush(file);
+    }
+  }
+  lock_checkpoint_file(file, 0);
+}
+
+/*------------------------------------------------------------------------------
+  Sperrt (lock = 1) bzw. entsperrt (lock = 0) die Checkpoint-Datei fr
+  andere Prozesse. Zurckgegeben wird -1 bei einem Fehler, sonst 0.
+------------------------------------------------------------------------------*/
+static int lock_checkpoint_file(FILE* file, int lock) {
+#ifdef _WIN32
+  HANDLE handle = (HANDLE) _get_osfhandle(_fileno(file));
+  OVERLAPPED overlapped;
+  memset(&overlapped, 0, sizeof(overlapped));
+  overlapped.Offset = CHECKPOINT_LOCK;
+  BOOL done = lock ? LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped)
+                   : UnlockFileEx(handle, 0, 1, 0, &overlapped);
+  return done ? 0 : -1;
+#else
+  struct flock region;
+  memset(&region, 0, sizeof(region));
+  region.l_type = lock ? F_WRLCK : F_UNLCK;
+  region.l_whence = SEEK_SET;
+  region.l_start = CHECKPOINT_LOCK;
+  region.l_len = 1;
+  while (fcntl(fileno(file), F_SETLKW, &region) != 0) {
+    if (errno != EINTR) {
+      return -1;
+    }
+  }
+  return 0;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+  Sucht (binr) den Index des ersten Checkpoints mit x' >= x (count, wenn es
+  keinen gibt).
+------------------------------------------------------------------------------*/
+static uint64 find_checkpoint_index(const Checkpoint* entries, uint64 count, uint64 x) {
+  uint64 left = 0;
+  uint64 right = count;
+  while (left < right) {
+    uint64 middle = left + (right - left) / 2;
+    if (entries[middle].x < x) {
+      left = middle + 1;
+    } else {
+      right = middle;
+    }
+  }
+  return left;
+}
+
+/*------------------------------------------------------------------------------
+  Sperrt bzw. entsperrt die Checkpoints fr andere Threads.
+------------------------------------------------------------------------------*/
+static void lock_checkpoints(Checkpoints* checkpoints) {
+#ifdef _WIN32
+  EnterCriticalSection(&checkpoints->mutex);
+#else
+  pthread_mutex_lock(&checkpoints->mutex);
+#endif
+}
+
+static void unlock_checkpoints(Checkpoints* checkpoints) {
+#ifdef _WIN32
+  LeaveCriticalSection(&checkpoints->mutex);
+#else
+  pthread_mutex_unlock(&checkpoints->mutex);
+#endif
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet pi(x) mit Hilfe der Checkpoints: vom nchsten bekannten Wert aus
+  (Checkpoint-Datei unter x, pi_table unter oder ber x) wird nur noch
+  gesiebt, wenn er nahe genug liegt. Sonst wird pi fr das nchste Vielfache
+  von CHECKPOINT_STRIDE unter x berechnet und gespeichert.
+
+  Mit Speichergrenze wird pi hchstens bis calc_pi_limit berechnet und ab
+  dort gesiebt, auer ein bekannter Wert liegt nher.
+------------------------------------------------------------------------------*/
+static uint64 lookup_prime_pi(Query* query, uint64 x) {
+  Checkpoints* checkpoints = query->checkpoints;
+  uint64 pi_limit = calc_pi_limit(query);
+  uint64 above = x / PI_TABLE_STRIDE + 1;   /* Wert in pi_table ber x */
+  Checkpoint checkpoint = { 0, 0 };
+
+  double start = get_seconds();
+  int is_found = find_known_pi(query, x, ~0ULL, &checkpoint);
+  if (   above < PI_TABLE_SIZE
+      && (is_found == 0 || above * PI_TABLE_STRIDE - x < x - checkpoint.x)) {
+    checkpoint.x = above * PI_TABLE_STRIDE;
+    checkpoint.pi = pi_table[above];
+    is_found = 1;
+  }
+  uint64 distance = checkpoint.x > x ? checkpoint.x - x : x - checkpoint.x;
+  if (   is_found == 0
+      || (prefer_sieve(distance, x) == 0 && (x <= pi_limit || distance > x - pi_limit))) {
+    if ((checkpoints == NULL || x < CHECKPOINT_STRIDE) && x <= pi_limit) {
+      uint64 pi = prime_pi(query, x);
+      add_timing(query, PHASE_BOUND, start);
+      return pi;
+    }
+    checkpoint.x = x < pi_limit ? x : pi_limit;
+    if (checkpoints != NULL) {
+      checkpoint.x -= checkpoint.x % CHECKPOINT_STRIDE;
+    }
+    checkpoint.pi = prime_pi(query, checkpoint.x);
+    if (checkpoints != NULL) {
+      add_checkpoint(checkpoints, checkpoint.x, checkpoint.pi);
+    }
+  }
+  add_timing(query, PHASE_BOUND, start);
+
+  Statistics statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  if (checkpoint.x != x) {
+    Query count_query = *query;
+    count_query.mode = MODE_COUNT;
+    if (checkpoint.x < x) {
+      sieve_statistics(&count_query, checkpoint.x + 1, x, &statistics);
+    } else {
+      sieve_statistics(&count_query, x + 1, checkpoint.x, &statistics);
+    }
+    count_query.mode = query->mode;   /* Zhler und Laufzeiten bernehmen */
+    *query = count_query;
+  }
+  return checkpoint.x <= x ? checkpoint.pi + statistics.count : checkpoint.pi - statistics.count;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt das grte x zurck, fr das prime_pi (estimate_pi_memory) in die
+  Hlfte von max_memory passt. Ohne Speichergrenze gilt das fr den
+  Hauptspeicher (ist auch der unbekannt: 2^64 - 1). Nahe 2^64 braucht
+  prime_pi etwa 120 MB und ein Segment je Thread, die Grenze greift also nur
+  bei sehr kleinem --max-memory.
+------------------------------------------------------------------------------*/
+static uint64 calc_pi_limit(const Query* query) {
+  uint64 memory = query->pi_memory / 2;
+  if (query->pi_memory == 0 || estimate_pi_memory(query, ~0ULL) <= memory) {
+    return ~0ULL;
+  }
+  uint64 low = 0;
+  uint64 high = ~0ULL;
+  while (low < high) {
+    uint64 middle = low + (high - low) / 2 + 1;
+    if (estimate_pi_memory(query, middle) <= memory) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return low;
+}
+
+/*------------------------------------------------------------------------------
+  Schtzt den Speicher von prime_pi(x) in Bytes: die Tabellen bis y (vor
+  allem 4 Bytes je ungerade Zahl fr die kleinsten Primfaktoren) und je
+  Thread das Segment mit Zhlern, die Werte je Primzahl bis sqrt(z) und
+  das Fenster fr P2.
+------------------------------------------------------------------------------*/
+static uint64 estimate_pi_memory(const Query* query, uint64 x) {
+  if (x < PI_MIN_X) {
+    return 0;
+  }
+  uint64 y = choose_pi_y(x);
+  uint64 z = x / y;
+  uint64 segment_bits = choose_pi_segment_bits(query, z);
+  uint64 tables =   (y / 2 + 1) * sizeof(int)
+                  + ((uint64) estimate_number_of_primes_up_to((uint32) y) + 2) * sizeof(uint32)
+                  + (y / 128 + 1) * (sizeof(uint64) + sizeof(uint32))
+                  + 30030 * sizeof(uint32) + 15016 * sizeof(uint64);   /* phi_table, pattern */
+  uint64 range =   segment_bits / 8 + segment_bits / PI_COUNTER_BITS * sizeof(uint32)
+                 + ((uint64) estimate_number_of_primes_up_to(integer_square_root(z)) + 2) * 4 * sizeof(uint64)
+                 + PI_WINDOW_BITS / 8 + PI_WINDOW_BITS * sizeof(uint32);
+  return tables + query->threads_count * range;
+}
+
+/*------------------------------------------------------------------------------
+  Entscheidet, ob es schneller ist, distance Zahlen unterhalb von x zu sieben
+  als pi(x) zu berechnen. prime_pi kostet auf einem Kern etwa so viel wie
+  das Sieben von x^(2/3) / 3 Zahlen (gemessen von 10^13 bis 10^17).
+------------------------------------------------------------------------------*/
+static int prefer_sieve(uint64 distance, uint64 x) {
+  return distance <= pow((double) x, 2.0 / 3.0) / 3;
+}
+
+/*==============================================================================
+  Primzahl-Zhlfunktion
+==============================================================================*/
+
+/*------------------------------------------------------------------------------
+  prime_pi(x) berechnet die Anzahl der Primzahlen <= x nach Lagarias, Miller
+  und Odlyzko, mit der Aufteilung der Bltter von Delglise und Rivat:
+
+    pi(x) = phi(x, a) + a - 1 - P2(x, a)   mit y = alpha * x^(1/3), a = pi(y)
+
+  phi(x, a) zhlt die Zahlen <= x ohne Primfaktor <= y, P2(x, a) die Zahlen
+  <= x mit genau zwei Primfaktoren > y. Die Rekursion
+  phi(v, b) = phi(v, b - 1) - phi(v / p_b, b - 1) wird nur so weit
+  aufgefaltet, dass phi(x, a) = S1 + S2 ist mit
+
+    S1 = Summe mu(n) * phi(x / n, c)        ber n <= y ohne Primfaktor <= p_c
+    S2 = Summe -mu(m) * phi(x / (p_b m), b - 1)
+                  ber c < b <= a und m <= y < p_b m ohne Primfaktor <= p_b
+
+  phi(v, c) steht in phi_table. Von den Blttern in S2 ist phi 1, wenn
+  x / (p_b m) < p_b ist ("trivial"), und pi(x / (p_b m)) - b + 2, wenn es
+  hchstens y und < p_b^2 ist ("leicht", aus prime_bits). Nur die brigen
+  ("schwer") liegen ber y und brauchen phi selbst. Sie werden beim Sieben
+  von [1, z] mit z = x / y gezhlt: vor dem Streichen von p_b stehen im Sieb
+  genau die Zahlen, die phi(v, b - 1) zhlt, und Zhler je PI_COUNTER_BITS
+  Bits ersparen das Zhlen ab dem Anfang des Segments. Jedes Segment
+  beginnt mit einem Muster, in dem p_2 bis p_c schon gestrichen sind. Nach
+  dem Streichen aller Primzahlen bis sqrt(z) liefert dasselbe Sieb
+  pi(x / p) fr P2.
+
+  [1, z] wird in threads_count * PI_ROUNDS Teilbereiche zerlegt, je Runde
+  bearbeitet jeder Thread einen davon (sieve_pi_range). Ein Teilbereich
+  zhlt phi und pi nur ab seinem Anfang; die Werte davor kommen erst beim
+  Zusammenfassen in der Reihenfolge der Teilbereiche dazu. Alle Summen
+  laufen modulo 2^64 (negative Zwischenwerte laufen ber), das Ergebnis
+  stimmt trotzdem, weil pi(x) < 2^64 ist.
+
+  Das Sieben kostet O(z log log z) = O(x^(2/3) / alpha log log x), der
+  Speicher ist O(y) fr die Tabellen und O(sqrt(z)) je Thread, beides
+  O(x^(1/3)). alpha wchst mit x (choose_pi_y), weil die schweren Bltter
+  mit grerem y seltener werden und das Sieb krzer.
+------------------------------------------------------------------------------*/
+static uint64 prime_pi(Query* query, uint64 x) {
+  if (x < 2) {
+    return 0;
+  }
+  if (x < PI_MIN_X) {
+    PiTables tables;
+    build_pi_tables(&tables, x, x);
+    uint64 pi = small_prime_pi(&tables, x);
+    free_pi_tables(&tables);
+    return pi;
+  }
+  return calc_prime_pi(query, x, choose_pi_y(x));
+}
+
+/*------------------------------------------------------------------------------
+  Whlt y = alpha * x^(1/3) fr prime_pi. alpha wurde auf einem Kern
+  gemessen (am schnellsten etwa 8 bei 10^14 und 10^15, 12 bis 24 bei 10^17,
+  das Optimum ist flach). y liegt immer zwischen x^(1/3) und sqrt(x).
+------------------------------------------------------------------------------*/
+static uint64 choose_pi_y(uint64 x) {
+  double alpha = 2 * (log10((double) x) - 10);
+  uint64 cube_root = (uint64) cbrt((double) x);
+  while (cube_root * cube_root * cube_root > x) {
+    cube_root -= 1;
+  }
+  uint64 y = (uint64) ((alpha > 1 ? alpha : 1) * (double) cube_root);
+  uint64 sqrt_x = integer_square_root(x);
+  return y <= cube_root ? cube_root + 1 : y > sqrt_x ? sqrt_x : y;
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet pi(x) mit dem gegebenen y (siehe prime_pi).
+------------------------------------------------------------------------------*/
+static uint64 calc_prime_pi(Query* query, uint64 x, uint64 y) {
+  PiTables tables;
+  build_pi_tables(&tables, x, y);
+  uint32 b_sieve = tables.b_sieve;
+
+  uint32 segment_bits = choose_pi_segment_bits(query, tables.z);
+  uint32 pieces = query->threads_count * PI_ROUNDS;
+  uint64 segments = tables.z / (2ULL * segment_bits) + 1;
+  uint64 piece_numbers = 2ULL * segment_bits * ((segments + pieces - 1) / pieces);
+
+  PiRange ranges[MAX_THREADS];
+  for (uint32 t = 0; t < query->threads_count; t++) {
+    init_pi_range(&ranges[t], &tables, query->kernels, segment_bits, pieces);
+  }
+  uint64* phi_starts;
+  if ((phi_starts = calloc((size_t) b_sieve + 1, sizeof(uint64))) == NULL) {
+    perror("memory error");
+    exit(5);
+  }
+
+  uint64 pi = calc_ordinary_leaves(&tables) + tables.a - 1;
+  uint64 p2 = 0;
+  uint64 p2_count = 0;
+  uint64 survivors = 0;
+  if (query->progress != NULL) {
+    query->phase_started = get_seconds();
+  }
+  for (uint32 round = 0; round < PI_ROUNDS; round++) {
+    Thread threads[MAX_THREADS];
+    for (uint32 t = 0; t < query->threads_count; t++) {
+      PiRange* range = &ranges[t];
+      range->piece = round * query->threads_count + t;
+      range->low = 1 + range->piece * piece_numbers;
+      range->high = tables.z - range->low < piece_numbers ? tables.z + 1 : range->low + piece_numbers;
+      if (range->low > tables.z) {
+        range->low = range->high = tables.z + 1;
+      }
+      if (t > 0) {
+        threads[t] = start_pi_thread(range);
+      }
+    }
+    sieve_pi_range(&ranges[0]);
+    for (uint32 t = 1; t < query->threads_count; t++) {
+      join_block_thread(threads[t]);
+    }
+
+    for (uint32 t = 0; t < query->threads_count; t++) {
+      PiRange* range = &ranges[t];
+      pi += range->leaves;
+      for (uint32 b = tables.c + 1; b <= b_sieve; b++) {
+        pi += range->leaf_signs[b] * phi_starts[b];
+        phi_starts[b] += range->phi_counts[b];
+      }
+      p2 += range->p2 + range->p2_count * survivors;
+      p2_count += range->p2_count;
+      survivors += range->survivors;
+    }
+    if (query->progress != NULL) {
+      report_progress(query, NTHPRIME_PHASE_PI, (round + 1.0) / PI_ROUNDS, x, 0, 0);
+    }
+  }
+
+  /* pi(v) = survivors bis v - 1 + b_sieve, davon je p_b noch b - 1 */
+  p2 += p2_count * (b_sieve - 1) - p2_count * tables.a - p2_count * (p2_count - 1) / 2;
+  pi -= p2;
+
+  for (uint32 t = 0; t < query->threads_count; t++) {
+    free_pi_range(&ranges[t]);
+  }
+  free(phi_starts);
+  free_pi_tables(&tables);
+  return pi;
+}
+
+/*------------------------------------------------------------------------------
+  Whlt die Bits je Segment von prime_pi: mindestens so viele wie ein
+  normales Segment hat und wie ungerade Zahlen bis sqrt(z), damit jede
+  Primzahl des Siebs hchstens einmal je Segment streicht, aber nicht mehr
+  als PI_MAX_SEGMENT_BITS. Immer ein Vielfaches von PI_COUNTER_BITS.
+------------------------------------------------------------------------------*/
+static uint32 choose_pi_segment_bits(const Query* query, uint64 z) {
+  uint32 segment_bits = 8 * query->segment_bytes;
+  uint32 root_bits = integer_square_root(z) / 2;
+  if (segment_bits < root_bits) {
+    segment_bits = root_bits < PI_MAX_SEGMENT_BITS ? root_bits : PI_MAX_SEGMENT_BITS;
+  }
+  return segment_bits + PI_COUNTER_BITS - 1 - (segment_bits - 1) % PI_COUNTER_BITS;
+}
+
+/*------------------------------------------------------------------------------
+  Legt die Tabellen bis y an: die Primzahlen, pi als Bits mit Zhlern je
+  128 Zahlen, den kleinsten Primfaktor mit mu fr ungerade Zahlen,
+  phi(v, c) fr v < p_1 * ... * p_c und daraus das Muster fr das Sieb.
+
+  Die kleinsten Primfaktoren entstehen wie bei einem Sieb: eine ungerade
+  Zahl, die noch keinen hat, ist prim, und fr jedes ihrer Vielfachen dreht
+  sie das Vorzeichen (mu) um. Danach werden die Vielfachen der Quadrate 0.
+------------------------------------------------------------------------------*/
+static void build_pi_tables(PiTables* tables, uint64 x, uint64 y) {
+  tables->x = x;
+  tables->y = y;
+  tables->z = x / y;
+  tables->sqrt_x = integer_square_root(x);
+  uint64 words = y / 128 + 1;
+  if (   (tables->factors = calloc(y / 2 + 1, sizeof(int))) == NULL
+      || (tables->primes = malloc(sizeof(uint32) * ((size_t) estimate_number_of_primes_up_to((uint32) y) + 2))) == NULL
+      || (tables->prime_bits = calloc(words, sizeof(uint64))) == NULL
+      || (tables->prime_counts = malloc(sizeof(uint32) * words)) == NULL) {
+    perror("memory error");
+    exit(5);
+  }
+
+  int* factors = tables->factors;
+  uint32 a = 0;
+  tables->primes[0] = 1;
+  tables->primes[++a] = 2;
+  for (uint64 p = 3; p <= y; p += 2) {
+    if (factors[p / 2] == 0) {
+      tables->primes[++a] = (uint32) p;
+      tables->prime_bits[p / 128] |= 1ULL << (p % 128 / 2);
+      for (uint64 m = p; m <= y; m += 2 * p) {
+        factors[m / 2] = factors[m / 2] == 0 ? -(int) p : -factors[m / 2];
+      }
+    }
+  }
+  for (uint32 b = 2; b <= a && (uint64) tables->primes[b] * tables->primes[b] <= y; b++) {
+    uint64 square = (uint64) tables->primes[b] * tables->primes[b];
+    for (uint64 m = square; m <= y; m += 2 * square) {
+      factors[m / 2] = 0;
+    }
+  }
+  factors[0] = 0x7fffffff;   /* 1: mu = 1, kein Primfaktor */
+  tables->a = a;
+
+  uint32 count = 1;   /* die 2 */
+  for (uint64 i = 0; i < words; i++) {
+    tables->prime_counts[i] = count;
+    count += (uint32) count_bits((const uint8*) &tables->prime_bits[i], 8);
+  }
+
+  tables->c = a < PI_TINY_PRIMES ? a : PI_TINY_PRIMES;
+  tables->phi_period = 1;
+  for (uint32 b = 1; b <= tables->c; b++) {
+    tables->phi_period *= tables->primes[b];
+  }
+  if ((tables->phi_table = malloc(sizeof(uint32) * tables->phi_period)) == NULL) {
+    perror("memory error");
+    exit(5);
+  }
+  uint32 phi = 0;
+  for (uint32 v = 0; v < tables->phi_period; v++) {
+    uint32 b = 1;
+    while (b <= tables->c && v % tables->primes[b] != 0) {
+      b += 1;
+    }
+    phi += v > 0 && b > tables->c;
+    tables->phi_table[v] = phi;
+  }
+  tables->phi_totient = phi + (tables->phi_period == 1);
+
+  tables->pattern_words = tables->phi_period / 2 + (tables->phi_period == 1);
+  if ((tables->pattern = calloc((size_t) tables->pattern_words + 1, sizeof(uint64))) == NULL) {
+    perror("memory error");
+    exit(5);
+  }
+  for (uint64 k = 0; k < 64ULL * tables->pattern_words; k++) {
+    uint64 v = (2 * k + 1) % tables->phi_period;
+    if (tables->phi_table[v] != (v == 0 ? 0 : tables->phi_table[v - 1])) {
+      tables->pattern[k / 64] |= 1ULL << k % 64;
+    }
+  }
+  tables->pattern[tables->pattern_words] = tables->pattern[0];
+
+  uint32 b_sqrt_z = (uint32) small_prime_pi(tables, integer_square_root(tables->z));
+  tables->b_sqrt_y = (uint32) small_prime_pi(tables, integer_square_root(y));
+  tables->b_sieve = b_sqrt_z > tables->c ? b_sqrt_z : tables->c;
+  if ((tables->leaf_ends = calloc((size_t) tables->b_sieve + 1, sizeof(uint64))) == NULL) {
+    perror("memory error");
+    exit(5);
+  }
+  for (uint32 b = tables->c + 1; b <= tables->b_sieve; b++) {
+    uint64 p = tables->primes[b];
+    uint64 xp = x / p;
+    uint64 q_max = xp / (y + 1) < y ? xp / (y + 1) : y;
+    if (b <= tables->b_sqrt_y) {
+      tables->leaf_ends[b] = xp / (y / p + 1);
+    } else if (q_max > p && b < a) {
+      tables->leaf_ends[b] = xp / tables->primes[b + 1];
+    }
+  }
+}
+
+static void free_pi_tables(PiTables* tables) {
+  free(tables->factors);
+  free(tables->primes);
+  free(tables->prime_bits);
+  free(tables->prime_counts);
+  free(tables->phi_table);
+  free(tables->pattern);
+  free(tables->leaf_ends);
+}
+
+/*------------------------------------------------------------------------------
+  pi(v) fr v <= y aus prime_bits.
+------------------------------------------------------------------------------*/
+static uint64 small_prime_pi(const PiTables* tables, uint64 v) {
+  if (v < 2) {
+    return 0;
+  }
+  uint64 rest = v % 128;   /* die ungeraden Zahlen 1, ..., rest */
+  uint64 bits = rest == 0 ? 0 : tables->prime_bits[v / 128] & (~0ULL >> (63 - (rest - 1) / 2));
+  return tables->prime_counts[v / 128] + count_bits((const uint8*) &bits, 8);
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet S1 (siehe prime_pi), die Summe ber die gewhnlichen Bltter.
+------------------------------------------------------------------------------*/
+static uint64 calc_ordinary_leaves(const PiTables* tables) {
+  int p_c = (int) tables->primes[tables->c];
+  uint64 sum = 0;
+  for (uint64 n = 1; n <= tables->y; n += 2) {
+    int factor = tables->factors[n / 2];
+    if (factor > p_c || factor < -p_c) {
+      uint64 v = tables->x / n;
+      uint64 phi = v / tables->phi_period * tables->phi_totient + tables->phi_table[v % tables->phi_period];
+      sum += factor > 0 ? phi : 0 - phi;
+    }
+  }
+  return sum;
+}
+
+/*------------------------------------------------------------------------------
+  Summiert die trivialen und leichten Bltter von p_b (p_b > sqrt(y), also
+  m = q prim mit p_b < q <= y).
+
+  Trivial sind die q > x / p_b^2. Bei den leichten ndert sich
+  pi(x / (p_b q)) zwischen benachbarten q oft nicht; solange x / (p_b q)
+  unter q liegt, werden alle q mit demselben Wert auf einmal gezhlt.
+------------------------------------------------------------------------------*/
+static uint64 calc_easy_leaves(const PiTables* tables, uint32 b) {
+  uint64 y = tables->y;
+  uint64 p = tables->primes[b];
+  uint64 xp = tables->x / p;
+  uint64 v = xp / p;
+  uint64 sum = v >= y ? 0 : tables->a - small_prime_pi(tables, v > p ? v : p);
+  uint64 u = xp / (y + 1);
+  if (v <= p || u >= y) {
+    return sum;
+  }
+
+  uint64 l_low = u > p ? small_prime_pi(tables, u) : b;
+  uint64 l_high = small_prime_pi(tables, v < y ? v : y);
+  for (uint64 l = l_low + 1; l <= l_high; ) {
+    uint64 q = tables->primes[l];
+    uint64 w = xp / q;
+    uint64 pi_w = small_prime_pi(tables, w);
+    uint64 l_end = l;
+    if (w < q) {
+      uint64 q_end = xp / tables->primes[pi_w];
+      l_end = small_prime_pi(tables, q_end < y ? q_end : y);
+      l_end = l_end < l_high ? l_end : l_high;
+    }
+    sum += (l_end - l + 1) * (pi_w - b + 2);
+    l = l_end + 1;
+  }
+  return sum;
+}
+
+/*------------------------------------------------------------------------------
+  Legt die Puffer eines Teilbereichs an.
+------------------------------------------------------------------------------*/
+static void init_pi_range(PiRange* range, const PiTables* tables, const Kernels* kernels,
+                          uint32 segment_bits, uint32 pieces) {
+  size_t b_count = (size_t) tables->b_sieve + 1;
+  range->tables = tables;
+  range->kernels = kernels;
+  range->segment_bits = segment_bits;
+  range->pieces = pieces;
+  if (   (range->sieve = malloc(segment_bits / 8)) == NULL
+      || (range->counters = malloc(sizeof(uint32) * (segment_bits / PI_COUNTER_BITS))) == NULL
+      || (range->multiples = malloc(sizeof(uint64) * b_count)) == NULL
+      || (range->leaf_signs = malloc(sizeof(uint64) * b_count)) == NULL
+      || (range->phi_counts = malloc(sizeof(uint64) * b_count)) == NULL
+      || (range->window = malloc(PI_WINDOW_BITS / 8)) == NULL
+      || (range->window_primes = malloc(sizeof(uint32) * PI_WINDOW_BITS)) == NULL) {
+    perror("memory error");
+    exit(5);
+  }
+}
+
+static void free_pi_range(PiRange* range) {
+  free(range->sieve);
+  free(range->counters);
+  free(range->multiples);
+  free(range->leaf_signs);
+  free(range->phi_counts);
+  free(range->window);
+  free(range->window_primes);
+}
+
+/*------------------------------------------------------------------------------
+  Bearbeitet einen Teilbereich (im Thread des Teilbereichs): die trivialen
+  und leichten Bltter der p_b mit b % pieces == piece und das Sieb von
+  [low, high) in Segmenten von segment_bits ungeraden Zahlen.
+------------------------------------------------------------------------------*/
+static void sieve_pi_range(PiRange* range) {
+  const PiTables* tables = range->tables;
+  size_t b_count = (size_t) tables->b_sieve + 1;
+  memset(range->leaf_signs, 0, sizeof(uint64) * b_count);
+  memset(range->phi_counts, 0, sizeof(uint64) * b_count);
+  range->leaves = 0;
+  range->p2 = 0;
+  range->p2_count = 0;
+  range->survivors = 0;
+
+  uint32 b_easy = (tables->c > tables->b_sqrt_y ? tables->c : tables->b_sqrt_y) + 1;
+  uint32 b = b_easy + (range->piece + range->pieces - b_easy % range->pieces) % range->pieces;
+  for ( ; b <= tables->a; b += range->pieces) {
+    range->leaves += calc_easy_leaves(tables, b);
+  }
+
+  if (range->low >= range->high) {
+    return;
+  }
+  for (b = tables->c + 1; b <= tables->b_sieve; b++) {
+    uint64 p = tables->primes[b];
+    uint64 multiple = (range->low + p - 1) / p * p;
+    range->multiples[b] = multiple % 2 == 0 ? multiple + p : multiple;
+  }
+  range->window_top = tables->x / range->low < tables->sqrt_x ? tables->x / range->low : tables->sqrt_x;
+  range->window_count = 0;
+  range->window_next = 0;
+
+  for (uint64 low = range->low; low < range->high; low += 2ULL * range->segment_bits) {
+    uint64 high = range->high - low < 2ULL * range->segment_bits ? range->high : low + 2ULL * range->segment_bits;
+    sieve_pi_segment(range, low, high);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Siebt das Segment [low, high) (low ungerade): p_2 bis p_c kommen aus dem
+  Muster, dann wird mit jedem weiteren p_b bis b_sieve gestrichen, vor dem
+  jeweils die schweren Bltter von p_b gezhlt werden. Nach dem letzten p_b
+  mit Blttern im Segment werden die Zhler nicht mehr mitgefhrt, sondern
+  am Ende neu gezhlt. Zum Schluss kommen die p von P2 mit x / p im Segment
+  dran.
+------------------------------------------------------------------------------*/
+static void sieve_pi_segment(PiRange* range, uint64 low, uint64 high) {
+  const PiTables* tables = range->tables;
+  uint64* sieve = range->sieve;
+  uint32 bits = (uint32) ((high - low + 1) / 2);
+  uint32 words = (bits + 63) / 64;
+  uint64 k = (low - 1) / 2 % (64ULL * tables->pattern_words);
+  uint32 i = (uint32) (k / 64);
+  uint32 shift = (uint32) (k % 64);
+  for (uint32 w = 0; w < words; w++) {
+    sieve[w] = shift == 0 ? tables->pattern[i]
+                          : tables->pattern[i] >> shift | tables->pattern[i + 1] << (64 - shift);
+    i = i + 1 == tables->pattern_words ? 0 : i + 1;
+  }
+  if (bits % 64 != 0) {
+    sieve[words - 1] &= (1ULL << bits % 64) - 1;
+  }
+
+  uint32 b_last = tables->c;
+  for (uint32 b = tables->c + 1; b <= tables->b_sieve; b++) {
+    b_last = tables->leaf_ends[b] >= low ? b : b_last;
+  }
+  uint64 survivors = count_pi_segment(range, words);
+  for (uint32 b = tables->c + 1; b <= b_last; b++) {
+    if (tables->leaf_ends[b] >= low) {
+      add_hard_leaves(range, b, low, high);
+    }
+    range->phi_counts[b] += survivors;
+    survivors -= cross_off_pi(range, b, low, bits, range->counters);
+  }
+  if (b_last < tables->b_sieve) {
+    for (uint32 b = b_last + 1; b <= tables->b_sieve; b++) {
+      cross_off_pi(range, b, low, bits, NULL);
+    }
+    survivors = count_pi_segment(range, words);
+  }
+
+  if (high > tables->sqrt_x) {
+    add_p2_primes(range, low, high);
+  }
+  range->survivors += survivors;
+}
+
+/*------------------------------------------------------------------------------
+  Zhlt die nicht gestrichenen Bits des Segments je PI_COUNTER_BITS in die
+  Zhler und gibt ihre Summe zurck.
+------------------------------------------------------------------------------*/
+static uint64 count_pi_segment(PiRange* range, uint32 words) {
+  uint64 count = 0;
+  for (uint32 w = 0; w < words; w += PI_COUNTER_BITS / 64) {
+    uint32 size = words - w < PI_COUNTER_BITS / 64 ? words - w : PI_COUNTER_BITS / 64;
+    range->counters[w / (PI_COUNTER_BITS / 64)]
+      = (uint32) range->kernels->count_bits((const uint8*) (range->sieve + w), 8 * size);
+    count += range->counters[w / (PI_COUNTER_BITS / 64)];
+  }
+  return count;
+}
+
+/*------------------------------------------------------------------------------
+  Streicht die ungeraden Vielfachen von p_b im Segment ab low und gibt
+  zurck, wie viele davon noch nicht gestrichen waren. Mit counters werden
+  die Zhler mitgefhrt.
+------------------------------------------------------------------------------*/
+static uint32 cross_off_pi(PiRange* range, uint32 b, uint64 low, uint32 bits, uint32* counters) {
+  uint64* sieve = range->sieve;
+  uint64 p = range->tables->primes[b];
+  uint64 j = (range->multiples[b] - low) / 2;
+  uint32 crossed = 0;
+  if (counters == NULL) {
+    for ( ; j < bits; j += p) {
+      sieve[j / 64] &= ~(1ULL << j % 64);
+    }
+  } else {
+    for ( ; j < bits; j += p) {
+      uint64 word = sieve[j / 64];
+      uint32 bit = (uint32) (word >> j % 64) & 1;
+      sieve[j / 64] = word & ~(1ULL << j % 64);
+      counters[j / PI_COUNTER_BITS] -= bit;
+      crossed += bit;
+    }
+  }
+  range->multiples[b] = low + 2 * j;
+  return crossed;
+}
+
+/*------------------------------------------------------------------------------
+  Zhlt die schweren Bltter von p_b, deren x / (p_b m) im Segment
+  [low, high) liegt. Sie kommen mit fallendem m, also aufsteigend im
+  Segment. Fr p_b <= sqrt(y) sind alle Bltter schwer, darber ist m = q
+  prim mit q <= x / (p_b (y + 1)).
+------------------------------------------------------------------------------*/
+static void add_hard_leaves(PiRange* range, uint32 b, uint64 low, uint64 high) {
+  const PiTables* tables = range->tables;
+  uint64 y = tables->y;
+  uint64 p = tables->primes[b];
+  uint64 xp = tables->x / p;
+  uint32 block = 0;
+  uint64 before = range->phi_counts[b];
+  uint64 sum = 0;
+  uint64 sign = 0;
+
+  if (b <= tables->b_sqrt_y) {
+    uint64 m_high = xp / low < y ? xp / low : y;
+    uint64 m_low = xp / high > y / p ? xp / high : y / p;
+    for (uint64 m = m_high - (m_high % 2 == 0); m > m_low; m -= 2) {
+      int factor = tables->factors[m / 2];
+      if (factor > (int) p || factor < -(int) p) {
+        uint64 phi = count_pi_survivors(range, (xp / m - low) / 2, &block, &before);
+        sum += factor > 0 ? 0 - phi : phi;
+        sign += factor > 0 ? ~0ULL : 1;
+      }
+    }
+  } else {
+    uint64 q_high = xp / (y + 1);
+    q_high = xp / low < q_high ? xp / low : q_high;
+    if (xp / high >= y || q_high <= p) {
+      return;
+    }
+    uint64 l_low = small_prime_pi(tables, xp / high);
+    uint64 l_high = small_prime_pi(tables, q_high < y ? q_high : y);
+    for (uint64 l = l_high; l > l_low && l > b; l--) {
+      sum += count_pi_survivors(range, (xp / tables->primes[l] - low) / 2, &block, &before);
+      sign += 1;
+    }
+  }
+  range->leaves += sum;
+  range->leaf_signs[b] += sign;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Anzahl der brigen Zahlen im Teilbereich bis zum Bit j des
+  Segments zurck. block und before (Summe der Zhler vor block, mit dem
+  Stand vor dem Segment) laufen mit, j darf nur wachsen.
+------------------------------------------------------------------------------*/
+static uint64 count_pi_survivors(const PiRange* range, uint64 j, uint32* block, uint64* before) {
+  uint32 k = (uint32) (j / PI_COUNTER_BITS);
+  while (*block < k) {
+    *before += range->counters[(*block)++];
+  }
+  const uint64* words = range->sieve + (uint64) k * (PI_COUNTER_BITS / 64);
+  uint32 full = (uint32) (j % PI_COUNTER_BITS / 64);
+  uint64 last = words[full] & (~0ULL >> (63 - j % 64));
+  return   *before + range->kernels->count_bits((const uint8*) words, 8 * full)
+         + count_bits((const uint8*) &last, 8);
+}
+
+/*------------------------------------------------------------------------------
+  Addiert fr jede Primzahl p in (y, sqrt(x)] mit x / p im Segment
+  [low, high) die brigen Zahlen bis x / p (siehe calc_prime_pi). Die p
+  kommen absteigend aus dem Fenster, x / p also aufsteigend.
+------------------------------------------------------------------------------*/
+static void add_p2_primes(PiRange* range, uint64 low, uint64 high) {
+  const PiTables* tables = range->tables;
+  uint64 p_low = tables->x / high > tables->y ? tables->x / high : tables->y;
+  uint32 block = 0;
+  uint64 before = range->survivors;
+  for (uint64 p = next_p2_prime(range); p > p_low; p = next_p2_prime(range)) {
+    range->window_next += 1;
+    range->p2 += count_pi_survivors(range, (tables->x / p - low) / 2, &block, &before);
+    range->p2_count += 1;
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die grte noch nicht verbrauchte Primzahl p in (y, window_top] des
+  Fensters zurck, 0 wenn es keine mehr gibt. Ist das Fenster leer, wird
+  das nchste darunter gesiebt (mit den Primzahlen bis x^(1/4) <= y).
+------------------------------------------------------------------------------*/
+static uint64 next_p2_prime(PiRange* range) {
+  const PiTables* tables = range->tables;
+  while (range->window_next == range->window_count) {
+    uint64 high = range->window_top;
+    if (high <= tables->y) {
+      return 0;
+    }
+    uint64 low = high - tables->y > 2 * PI_WINDOW_BITS ? high - 2 * PI_WINDOW_BITS + 1 : tables->y + 1;
+    range->window_top = low - 1;
+    range->window_count = 0;
+    range->window_next = 0;
+    low |= 1;
+    if (low > high) {
+      continue;
+    }
+
+    uint32 bits = (uint32) ((high - low) / 2 + 1);
+    memset(range->window, 0xff, sizeof(uint64) * ((bits + 63) / 64));
+    for (uint32 b = 2; b <= tables->a && (uint64) tables->primes[b] * tables->primes[b] <= high; b++) {
+      uint64 q = tables->primes[b];
+      uint64 multiple = (low + q - 1) / q * q;
+      for (uint64 j = (multiple % 2 == 0 ? multiple + q - low : multiple - low) / 2; j < bits; j += q) {
+        range->window[j / 64] &= ~(1ULL << j % 64);
+      }
+    }
+    for (uint32 j = bits; j-- > 0; ) {
+      if (range->window[j / 64] >> j % 64 & 1) {
+        range->window_primes[range->window_count++] = (uint32) (low + 2ULL * j);
+      }
+    }
+  }
+  return range->window_primes[range->window_next];
+}
+
+/*------------------------------------------------------------------------------
+  Startet einen Thread, der sieve_pi_range(range) ausfhrt.
+------------------------------------------------------------------------------*/
+#ifdef _WIN32
+static DWORD WINAPI pi_thread(LPVOID range) {
+  sieve_pi_range(range);
+  return 0;
+}
+
+static Thread start_pi_thread(PiRange* range) {
+  Thread thread = CreateThread(NULL, 0, pi_thread, range, 0, NULL);
+  if (thread == NULL) {
+    fprintf(stderr, "thread error\n");
+    exit(6);
+  }
+  return thread;
+}
+#else
+static void* pi_thread(void* range) {
+  sieve_pi_range(range);
+  return NULL;
+}
+
+static Thread start_pi_thread(PiRange* range) {
+  Thread thread;
+  if (pthread_create(&thread, NULL, pi_thread, range) != 0) {
+    perror("thread error");
+    exit(6);
+  }
+  return thread;
+}
+#endif
+
+/*==============================================================================
+  allgemeine Funktionen
+==============================================================================*/
+
+/*------------------------------------------------------------------------------
+  inverse_pi(n) ist eine obere Schranke fr die n-te Primzahl (Dusart 2010,
+  Rosser/Schoenfeld 1962 fr kleine n):
+
+    p(n) <= n * (ln n + ln ln n - 1 + (ln ln n - 2) / ln n)   fr n >= 688383
+    p(n) <  n * (ln n + ln ln n)                             fr n >= 6
+
+  Fr n = 10^9 ist sie nur um 0,01% zu gro. Gerechnet wird in long double,
+  zum Schutz gegen Rundungsfehler wird noch etwas aufgeschlagen. Da die
+  ersten MAX_PI_N = pi(2^64 - 1) Primzahlen unter 2^64 liegen, wird auf
+  2^64 - 1 begrenzt.
+
+  Wenn n > pi(2^64 - 1) ist, wird 0 zurckgegeben.
+------------------------------------------------------------------------------*/
+static uint64 inverse_pi(uint64 n) {
+  static const uint64 small[6] = { 0, 2, 3, 5, 7, 11 };
+  if (n < 6) {
+    return small[n];
+  }
+  if (n > MAX_PI_N) {
+    return 0;
+  }
+
+  long double ln_n = logl((long double) n);
+  long double ln_ln_n = logl(ln_n);
+  long double x = n >= 688383 ? n * (ln_n + ln_ln_n - 1 + (ln_ln_n - 2) / ln_n)
+                              : n * (ln_n + ln_ln_n);
+  x = x * (1 + 1e-15L) + 1;
+  return x >= 18446744073709551615.0L ? 18446744073709551615ULL : (uint64) x;
+}
+
+/*------------------------------------------------------------------------------
+  inverse_pi_lower(n) ist eine untere Schranke fr die n-te Primzahl
+  (Dusart 2010, fr n >= 3):
+
+    p(n) >= n * (ln n + ln ln n - 1 + (ln ln n - 2,1) / ln n)
+
+  Zum Schutz gegen Rundungsfehler wird noch etwas abgezogen.
+------------------------------------------------------------------------------*/
+static uint64 inverse_pi_lower(uint64 n) {
+  if (n < 3) {
+    return n == 1 ? 2 : n == 2 ? 3 : 0;
+  }
+  if (n > MAX_PI_N) {
+    n = MAX_PI_N;
+  }
+
+  long double ln_n = logl((long double) n);
+  long double ln_ln_n = logl(ln_n);
+  long double x = n * (ln_n + ln_ln_n - 1 + (ln_ln_n - 2.1L) / ln_n);
+  x = x * (1 - 1e-15L) - 1;
+  return x <= 2 ? 2 : (uint64) x;
+}
+
+/*------------------------------------------------------------------------------
+  inverse_li(n) ist eine Nherung fr die n-te Primzahl, nmlich die Umkehrung
+  des Integrallogarithmus li(x), berechnet mit dem Newton-Verfahren:
+
+    x' = x - (li(x) - n) * ln(x)
+------------------------------------------------------------------------------*/
+static uint64 inverse_li(uint64 n) {
+  long double x = (long double) n * logl((long double) n);
+  for (int i = 0; i < 20; i++) {
+    long double dx = (li(x) - n) * logl(x);
+    x -= dx;
+    if (fabsl(dx) < 1.0L) {
+      break;
+    }
+  }
+  return x > 18446744073709551615.0L ? 18446744073709551615ULL : (uint64) x;
+}
+
+/*------------------------------------------------------------------------------
+  Integrallogarithmus li(x) als Reihe nach Ramanujan:
+
+    li(x) = gamma + ln(ln(x))
+          + sqrt(x) * Summe((-1)^(k-1) * ln(x)^k / (k! * 2^(k-1))
+                             * Summe(1 / (2j+1), j = 0..(k-1)/2), k = 1..)
+------------------------------------------------------------------------------*/
+static long double li(long double x) {
+  const long double gamma = 0.5772156649015328606065120900824L;
+  long double ln_x = logl(x);
+  long double sum = 0;
+  long double term = -1;   /* (-1)^(k-1) * ln(x)^k / (k! * 2^(k-1)) */
+  long double inner = 0;   /* Summe(1 / (2j+1), j = 0..(k-1)/2) */
+
+  for (int k = 1; k < 1000; k++) {
+    term *= -ln_x / (k * (k > 1 ? 2 : 1));
+    if (k % 2 == 1) {
+      inner += 1.0L / k;
+    }
+    long double addend = term * inner;
+    sum += addend;
+    if (fabsl(addend) < 1e-20L * fabsl(sum)) {
+      break;
+    }
+  }
+  return gamma + logl(ln_x) + sqrtl(x) * sum;
+}
+
+/*------------------------------------------------------------------------------
+  Multipliziert zwei 64-Bit-Zahlen zu einer 128-Bit-Zahl.
+------------------------------------------------------------------------------*/
+static uint128 multiply_64(uint64 a, uint64 b) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 p = (unsigned __int128) a * b;
+  uint128 product;
+  product.lo = (uint64) p;
+  product.hi = (uint64) (p >> 64);
+  return product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+  uint128 product;
+  product.lo = _umul128(a, b, &product.hi);
+  return product;
+#else
+  uint64 a_lo = a & 0xffffffff, a_hi = a >> 32;
+  uint64 b_lo = b & 0xffffffff, b_hi = b >> 32;
+  uint64 p0 = a_lo * b_lo;
+  uint64 p1 = a_lo * b_hi;
+  uint64 p2 = a_hi * b_lo;
+  uint64 p3 = a_hi * b_hi;
+  uint64 middle = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff);
+
+  uint128 product;
+  product.lo = (p0 & 0xffffffff) | middle << 32;
+  product.hi = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+  return product;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+  Miller-Rabin-Test der ungeraden Zahl n > 1 zu den 7 Basen von Jim Sinclair,
+  der fr alle n < 2^64 sicher ist (es gibt keine starke Pseudoprimzahl zu
+  allen).
+
+  Gerechnet wird in Montgomery-Darstellung a * 2^64 mod n, so dass jede
+  Multiplikation modulo n ohne Division auskommt. 2^128 mod n fr die
+  Umrechnung entsteht durch 64-maliges Verdoppeln von 2^64 mod n.
+------------------------------------------------------------------------------*/
+static int miller_rabin(uint64 n) {
+  static const uint64 bases[7] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+
+  /* n_inverse = 1 / n mod 2^64 nach Newton (n * n = 1 mod 8, je Schritt
+     doppelt so viele richtige Bits) */
+  uint64 n_inverse = n;
+  for (uint32 i = 0; i < 5; i++) {
+    n_inverse *= 2 - n * n_inverse;
+  }
+  uint64 one = (0 - n) % n;
+  uint64 minus_one = n - one;
+  uint64 r2 = one;
+  for (uint32 i = 0; i < 64; i++) {
+    r2 = r2 >= n - r2 ? r2 - (n - r2) : 2 * r2;
+  }
+  uint64 d = n - 1;
+  uint32 s = 0;
+  while ((d & 1) == 0) {
+    d >>= 1;
+    s += 1;
+  }
+  uint32 d_bits = 1;
+  while (d_bits < 64 && d >> d_bits != 0) {
+    d_bits += 1;
+  }
+
+  for (uint32 i = 0; i < 7; i++) {
+    uint64 a = bases[i] % n;
+    if (a == 0) {
+      continue;
+    }
+    a = montgomery_multiply(a, r2, n, n_inverse);
+    uint64 x = a;
+    for (uint32 bit = d_bits - 1; bit-- > 0; ) {
+      x = montgomery_multiply(x, x, n, n_inverse);
+      if (d >> bit & 1) {
+        x = montgomery_multiply(x, a, n, n_inverse);
+      }
+    }
+    if (x == one || x == minus_one) {
+      continue;
+    }
+    uint32 r;
+    for (r = 1; r < s; r++) {
+      x = montgomery_multiply(x, x, n, n_inverse);
+      if (x == minus_one) {
+        break;
+      }
+    }
+    if (r >= s) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt a * b / 2^64 mod n zurck (a, b < n, n ungerade, n_inverse = 1 / n
+  mod 2^64). Mit m = a * b * n_inverse mod 2^64 ist a * b - m * n durch
+  2^64 teilbar, es gengen also die oberen Hlften.
+------------------------------------------------------------------------------*/
+static uint64 montgomery_multiply(uint64 a, uint64 b, uint64 n, uint64 n_inverse) {
+  uint128 t = multiply_64(a, b);
+  uint64 mn = multiply_64(t.lo * n_inverse, n).hi;
+  return t.hi >= mn ? t.hi - mn : t.hi - mn + n;
+}
+
+/*------------------------------------------------------------------------------
+  Siebt bytes (<= LOCAL_BYTES) Bytes ab low (Vielfaches von 30) mit
+  local_primes; brig bleiben die Zahlen ohne Teiler bis 251 und diese
+  Primzahlen selbst. Bytes, die ber 2^64 hinaus reichen, fallen weg.
+  Zurckgegeben wird die Anzahl der gesiebten Bytes.
+------------------------------------------------------------------------------*/
+static uint32 sieve_local(uint64 low, uint32 bytes, uint8* sieve) {
+  if (bytes > (~0ULL - low) / 30) {
+    bytes = (uint32) ((~0ULL - low) / 30);
+  }
+  memset(sieve, 0xff, bytes);
+  if (low == 0) {
+    sieve[0] &= 0xfe;   /* 1 */
+  }
+  for (uint32 i = 0; i < sizeof(local_primes); i++) {
+    uint64 p = local_primes[i];
+    uint64 offset = low < p * p ? p * p - low : (p - low % p) % p;
+    for ( ; offset < 30ULL * bytes; offset += p) {
+      if (wheel_bit[offset % 30] != 0xff) {
+        sieve[offset / 30] &= (uint8) ~(1 << wheel_bit[offset % 30]);
+      }
+    }
+  }
+  return bytes;
+}
+
+/*------------------------------------------------------------------------------
+  Addiert b zu a (128 Bit).
+------------------------------------------------------------------------------*/
+static void add_128(uint128* a, uint128 b) {
+  a->lo += b.lo;
+  a->hi += b.hi + (a->lo < b.lo);
+}
+
+/*------------------------------------------------------------------------------
+  Verknpft zwei Byte-Arrays bitweise mit UND (je 8 Bytes auf einmal).
+------------------------------------------------------------------------------*/
+static void and_bytes(uint8* target, const uint8* a, const uint8* b, uint32 size) {
+  uint32 i = 0;
+  for ( ; i + 8 <= size; i += 8) {
+    uint64 x;
+    uint64 y;
+    memcpy(&x, a + i, 8);
+    memcpy(&y, b + i, 8);
+    x &= y;
+    memcpy(target + i, &x, 8);
+  }
+  for ( ; i < size; i++) {
+    target[i] = a[i] & b[i];
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Liest die ersten 8 Bytes (oder weniger, wenn size < 8) als 64-Bit-Wort,
+  Byte i in den Bits 8 * i bis 8 * i + 7.
+------------------------------------------------------------------------------*/
+static uint64 load_bits(const uint8* bytes, uint32 size) {
+  uint64 bits = 0;
+  if (size >= 8) {
+    for (uint32 i = 0; i < 8; i++) {
+      bits |= (uint64) bytes[i] << 8 * i;
+    }
+  } else {
+    for (uint32 i = 0; i < size; i++) {
+      bits |= (uint64) bytes[i] << 8 * i;
+    }
+  }
+  return bits;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Nummer des niedrigsten gesetzten Bits zurck (bits != 0).
+------------------------------------------------------------------------------*/
+static uint32 lowest_bit(uint64 bits) {
+#if defined(__GNUC__)
+  return (uint32) __builtin_ctzll(bits);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return (uint32) index;
+#else
+  /* De-Bruijn-Folge: das isolierte Bit whlt einen eindeutigen Index */
+  static const uint8 index[64] = {
+     0,  1,  2, 53,  3,  7, 54, 27,  4, 38, 41,  8, 34, 55, 48, 28,
+    62,  5, 39, 46, 44, 42, 22,  9, 24, 35, 59, 56, 49, 18, 29, 11,
+    63, 52,  6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+    51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12
+  };
+  return index[((bits & (0 - bits)) * 0x022fdd63cc95386dULL) >> 58];
+#endif
+}
+
+/*------------------------------------------------------------------------------
+  Zhlt die gesetzten Bits in einem Byte-Array.
+
+  Je 8 Bytes werden als 64-Bit-Wort parallel gezhlt (SWAR).
+------------------------------------------------------------------------------*/
+static uint64 count_bits(const uint8* bytes, uint32 size) {
+  uint64 count = 0;
+  uint32 i = 0;
+  for ( ; i + 8 <= size; i += 8) {
+    uint64 x;
+    memcpy(&x, bytes + i, 8);
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    count += (x * 0x0101010101010101ULL) >> 56;
+  }
+  for ( ; i < size; i++) {
+    for (uint8 b = bytes[i]; b != 0; b &= b - 1) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+/*------------------------------------------------------------------------------
+  Gibt die Zeit in Sekunden seit einem beliebigen, festen Zeitpunkt zurck
+  (monoton, fr Laufzeiten).
+------------------------------------------------------------------------------*/
+static double get_seconds(void) {
+#ifdef _WIN32
+  LARGE_INTEGER counter;
+  LARGE_INTEGER frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return (double) counter.QuadPart / (double) frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet ISQRT = die ganzzahlige 32-Bit Qudratwurzel einer 64-Bit-Zahl.
+  Es gilt: ISQRT^2 <= x.
+------------------------------------------------------------------------------*/
+static uint32 integer_square_root(uint64 x) {
+  double root = sqrt((double) x);
+  uint32 y = root >= 4294967295.0 ? 4294967295U : (uint32) root;
+  return ((uint64) y * (uint64) y <= x) ? y : (y - 1);
+}
+
+/*------------------------------------------------------------------------------
+  Berechnet eine Abschtzung EPRIM fr die Anzahl der Primzahlen <= x.
+  Es gilt: EPRIM >= pi(x)
+
+  Unter 64 wird der Nenner der Formel klein und bei x = 14 sogar negativ,
+  dort reicht der konstante Teil 158 allein.
+------------------------------------------------------------------------------*/
+static uint32 estimate_number_of_primes_up_to(uint32 x) {
+  if (x < 64) {
+    return 158;
+  }
+  return (uint32) (158 + (double) x
+                         / (log(x) - 1.052400915 - (log(4294967295U) - log(x))
+                                                 * 0.08149));
+//return (uint32) (158 + (double) x / (log(x) * 1.08149 - 2.859906955));
+}
+
+#ifdef X86_KERNELS
+/*------------------------------------------------------------------------------
+  Wie count_bits, aber mit dem Befehl POPCNT fr je 8 Bytes.
+------------------------------------------------------------------------------*/
+TARGET("popcnt")
+static uint64 count_bits_popcnt(const uint8* bytes, uint32 size) {
+  uint64 count = 0;
+  uint32 i = 0;
+  for ( ; i + 8 <= size; i += 8) {
+    uint64 x;
+    memcpy(&x, bytes + i, 8);
+    count += POPCOUNT_64(x);
+  }
+  for ( ; i < size; i++) {
+    count += POPCOUNT_64(bytes[i]);
+  }
+  return count;
+}
+
+/*------------------------------------------------------------------------------
+  Wie count_bits, aber mit AVX2 fr je 32 Bytes (nach W. Mula): die Bits
+  jedes Halbbytes werden per Tabelle (vpshufb) gezhlt, die Zhler je Byte
+  aufaddiert und sptestens nach 31 Runden (<= 248) mit vpsadbw in 64-Bit-
+  Summen bertragen.
+------------------------------------------------------------------------------*/
+TARGET("avx2,popcnt")
+static uint64 count_bits_avx2(const uint8* bytes, uint32 size) {
+  const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i totals = _mm256_setzero_si256();
+  uint32 i = 0;
+  while (i + 32 <= size) {
+    __m256i counts = _mm256_setzero_si256();
+    for (uint32 round = 0; round < 31 && i + 32 <= size; round++, i += 32) {
+      __m256i x = _mm256_loadu_si256((const __m256i*) (bytes + i));
+      __m256i low = _mm256_and_si256(x, low_mask);
+      __m256i high = _mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask);
+      counts = _mm256_add_epi8(counts, _mm256_shuffle_epi8(table, low));
+      counts = _mm256_add_epi8(counts, _mm256_shuffle_epi8(table, high));
+    }
+    totals = _mm256_add_epi64(totals, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+  uint64 lanes[4];
+  _mm256_storeu_si256((__m256i*) lanes, totals);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + count_bits_popcnt(bytes + i, size - i);
+}
+
+/*------------------------------------------------------------------------------
+  Wie and_bytes, aber mit AVX2 fr je 32 Bytes.
+------------------------------------------------------------------------------*/
+TARGET("avx2")
+static void and_bytes_avx2(uint8* target, const uint8* a, const uint8* b, uint32 size) {
+  uint32 i = 0;
+  for ( ; i + 32 <= size; i += 32) {
+    __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+    _mm256_storeu_si256((__m256i*) (target + i), _mm256_and_si256(x, y));
+  }
+  and_bytes(target + i, a + i, b + i, size - i);
+}
+#endif
@@ -0,0 +1,217 @@
+/*------------------------------------------------------------------------------
+  N T H P R I M E . H
+
+  Schnittstelle der Bibliothek libnthprime
+
+  Alle Einstellungen stehen in einem Kontext (NthPrime), die Bibliothek selbst
+  hat keine globalen Variablen. Ein Kontext wird nach dem Anlegen nur noch
+  gelesen und kann daher von mehreren Threads gleichzeitig benutzt werden,
+  ein Iterator dagegen nur von einem.
+
+  Alle Zahlen sind < 2^64. Nummern zhlen ab 1 (die 1. Primzahl ist 2).
+  Bei Speichermangel wird das Programm mit einer Fehlermeldung beendet.
+
+  Static: make lib -> libnthprime.a  (Windows: nthprime.lib)
+  Shared: make lib -> libnthprime.so (Windows: nthprime.dll)
+------------------------------------------------------------------------------*/
+#ifndef NTHPRIME_H
+#define NTHPRIME_H
+
+#if defined(_WIN32) && defined(NTHPRIME_BUILD_DLL)
+#define NTHPRIME_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(NTHPRIME_DLL)
+#define NTHPRIME_API __declspec(dllimport)
+#else
+#define NTHPRIME_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NTHPRIME_MAX_THREADS     256
+#define NTHPRIME_MAX_SEGMENT_KIB 65536
+#define NTHPRIME_MAX_GAP         2048  /* > grter Abstand zweier Primzahlen < 2^64 */
+#define NTHPRIME_MAX_PATTERNS    8     /* Muster je nthprime_tuples */
+
+/* Muster fr nthprime_tuples: Bit d steht fr p + d */
+#define NTHPRIME_TWINS           0x5ULL    /* p, p + 2 */
+#define NTHPRIME_TRIPLET_A       0x45ULL   /* p, p + 2, p + 6 */
+#define NTHPRIME_TRIPLET_B       0x51ULL   /* p, p + 4, p + 6 */
+#define NTHPRIME_QUADRUPLET      0x145ULL  /* p, p + 2, p + 6, p + 8 */
+
+typedef struct NthPrime NthPrime;
+typedef struct NthPrimeIterator NthPrimeIterator;
+
+/* Laufzeiten der Phasen in Sekunden */
+typedef struct {
+  double total;          /* Abfragen insgesamt */
+  double bound;          /* Schranken und pi(x) fr den Anfang des Siebs */
+  double base;           /* Sieb der Primfaktoren bis zur Wurzel */
+  double segments;       /* Sieben der Segmente */
+  double output;         /* Auswerten der Segmente und Melden der Primzahlen */
+} NthPrimeTimings;
+
+/* Fortschritt einer laufenden Abfrage */
+#define NTHPRIME_PHASE_PI    0   /* pi(x) wird berechnet */
+#define NTHPRIME_PHASE_SIEVE 1   /* die Segmente werden gesiebt */
+
+typedef struct {
+  int    phase;          /* NTHPRIME_PHASE_PI oder NTHPRIME_PHASE_SIEVE */
+  double seconds;        /* seit Beginn der Abfrage */
+  double phase_seconds;  /* seit Beginn der Phase */
+  double done;           /* erledigter Anteil der Phase (0 bis 1, geschtzt) */
+  unsigned long long z;         /* pi: x, sieve: bis hierher ist gesiebt */
+  unsigned long long numbers;   /* in der Phase gesiebte Zahlen */
+  unsigned long long primes;    /* Nummer (bzw. Anzahl) der gefundenen Primzahlen */
+  unsigned long long segments;  /* gesiebte Segmente */
+  unsigned long long crossings; /* gestrichene Vielfache in den Segmenten */
+  double marking;        /* Zeit fr das Sieben der Segmente */
+  double scanning;       /* Zeit fr das Auswerten der Segmente */
+} NthPrimeProgress;
+
+typedef void (*NthPrimeProgressCallback)(void* data, const NthPrimeProgress* progress);
+
+/* Teilergebnis eines Bereichs, mehrere lckenlos aneinander grenzende
+   Bereiche ergeben mit nthprime_merge_shards die absoluten Nummern */
+typedef struct {
+  unsigned long long a;          /* Bereich [a, b] */
+  unsigned long long b;
+  unsigned long long count;      /* Anzahl der Primzahlen darin */
+  unsigned long long first;      /* kleinste und grte (0: keine) */
+  unsigned long long last;
+  unsigned long long index;      /* Nummer von first (nach nthprime_merge_shards) */
+} NthPrimeShard;
+
+/* Wird fr jede Primzahl aufgerufen, ein Rckgabewert != 0 bricht ab. */
+typedef int (*NthPrimeCallback)(void* data, unsigned long long index,
+                                unsigned long long prime);
+
+/* Wird fr jeden gefundenen Abstand zwischen den aufeinander folgenden
+   Primzahlen p < q aufgerufen, ein Rckgabewert != 0 bricht ab. */
+typedef int (*NthPrimeGapCallback)(void* data, unsigned long long p, unsigned long long q);
+
+/* Wird fr jedes gefundene Tupel ab p mit seinem Muster aufgerufen, ein
+   Rckgabewert != 0 bricht ab. */
+typedef int (*NthPrimeTupleCallback)(void* data, unsigned long long p,
+                                     unsigned long long pattern);
+
+/* Kontext mit 1 Thread und einem Segment in der Gre des L1-Daten-Caches */
+NTHPRIME_API NthPrime* nthprime_create(void);
+NTHPRIME_API void nthprime_destroy(NthPrime* context);
+NTHPRIME_API void nthprime_set_threads(NthPrime* context, unsigned int threads_count);
+NTHPRIME_API void nthprime_set_segment_bytes(NthPrime* context, unsigned int segment_bytes);
+
+/* Ungefhre Obergrenze fr den Speicher einer Abfrage in Bytes (0: keine,
+   Standard). Passen die Primfaktoren bis zur Wurzel mit ihren Eimern nicht
+   hinein, werden die groen als Abstnde (1 Byte je Primzahl) gespeichert
+   und je Block neu angesetzt, was etwas langsamer ist; pi(x) wird nur so
+   weit berechnet, wie es hineinpasst, darber wird gesiebt. Das
+   inkrementelle Verfahren hlt sich nicht an die Grenze. */
+NTHPRIME_API void nthprime_set_max_memory(NthPrime* context, unsigned long long max_memory);
+
+/* Verfahren zum Melden der Primzahlen: "segmented", "incremental" oder
+   "auto" (Standard: je Abfrage das schnellere); -1: unbekannter Name.
+   Zhlen, pi(x), Stapel und Iterator sieben immer segmentiert.
+   nthprime_engine_name(i) liefert den Namen des i-ten (NULL: keins mehr). */
+NTHPRIME_API int nthprime_set_engine(NthPrime* context, const char* name);
+NTHPRIME_API const char* nthprime_engine_name(unsigned int i);
+
+/* Checkpoint-Datei mit Paaren (x, pi(x)), die beim ffnen im Speicher
+   abgebildet und whrend der Berechnungen ergnzt wird (NULL: keine);
+   -1: Datei kann nicht geffnet werden (siehe errno, EINVAL: keine oder
+   eine beschdigte Checkpoint-Datei) */
+NTHPRIME_API int nthprime_set_checkpoint_file(NthPrime* context, const char* path);
+
+/* Addiert die Laufzeiten aller folgenden Abfragen zu *timings (NULL: keine
+   Messung); dann darf der Kontext nicht von mehreren Threads gleichzeitig
+   benutzt werden */
+NTHPRIME_API void nthprime_set_timings(NthPrime* context, NthPrimeTimings* timings);
+
+/* Ruft whrend langer Abfragen etwa alle interval Sekunden callback auf
+   (NULL: nie); aus dem Thread, der die Abfrage gestartet hat */
+NTHPRIME_API void nthprime_set_progress(NthPrime* context, double interval,
+                                        NthPrimeProgressCallback callback, void* data);
+
+/* n-te Primzahl (0: zu gro) und Anzahl der Primzahlen <= x */
+NTHPRIME_API unsigned long long nthprime_nth_prime(NthPrime* context, unsigned long long n);
+NTHPRIME_API unsigned long long nthprime_prime_pi(NthPrime* context, unsigned long long x);
+
+/* Primzahltest (sicher fr alle x < 2^64, Miller-Rabin) sowie kleinste
+   Primzahl > x und grte < x (0: keine); ohne Kontext, da nur ein kurzes
+   Stck um x gesiebt wird */
+NTHPRIME_API int nthprime_is_prime(unsigned long long x);
+NTHPRIME_API unsigned long long nthprime_next_prime(unsigned long long x);
+NTHPRIME_API unsigned long long nthprime_prev_prime(unsigned long long x);
+
+/* Meldet die n_start-te bis n-te Primzahl mit ihrer Nummer (-1: n zu gro) */
+NTHPRIME_API int nthprime_primes(NthPrime* context, unsigned long long n_start,
+                                 unsigned long long n, NthPrimeCallback callback, void* data);
+
+/* Meldet die n_start[i]-te bis n[i]-te Primzahl aller count Bereiche in
+   einem Durchgang, aufsteigend und jede nur einmal (-1: ein n[i] zu gro) */
+NTHPRIME_API int nthprime_primes_batch(NthPrime* context, const unsigned long long* n_start,
+                                       const unsigned long long* n, unsigned long long count,
+                                       NthPrimeCallback callback, void* data);
+
+/* Meldet alle Primzahlen in [a, b], die Nummer zhlt ab der ersten >= a */
+NTHPRIME_API void nthprime_primes_between(NthPrime* context, unsigned long long a,
+                                          unsigned long long b, NthPrimeCallback callback,
+                                          void* data);
+
+/* Schreibt hchstens size Primzahlen aus [a, b] nach primes und gibt ihre
+   Anzahl zurck */
+NTHPRIME_API unsigned long long nthprime_fill(NthPrime* context, unsigned long long a,
+                                              unsigned long long b, unsigned long long* primes,
+                                              unsigned long long size);
+
+/* Anzahl, Summe (128 Bit) und Abstnde der Primzahlen in [a, b];
+   gaps hat NTHPRIME_MAX_GAP / 2 + 1 Eintrge, gaps[g / 2] zhlt den Abstand g
+   (gaps[0] den Abstand 1 zwischen 2 und 3) */
+NTHPRIME_API unsigned long long nthprime_count(NthPrime* context, unsigned long long a,
+                                               unsigned long long b);
+NTHPRIME_API void nthprime_sum(NthPrime* context, unsigned long long a, unsigned long long b,
+                               unsigned long long* sum_hi, unsigned long long* sum_lo);
+NTHPRIME_API void nthprime_gaps_histogram(NthPrime* context, unsigned long long a,
+                                          unsigned long long b, unsigned long long* gaps);
+
+/* Meldet aufsteigend alle Abstnde q - p >= min_gap aufeinander folgender
+   Primzahlen p < q in [a, b] bzw. nur die Rekorde (grer als alle
+   vorigen Abstnde in [a, b], der erste ist immer einer) */
+NTHPRIME_API void nthprime_gaps(NthPrime* context, unsigned long long a, unsigned long long b,
+                                unsigned long long min_gap, NthPrimeGapCallback callback,
+                                void* data);
+NTHPRIME_API void nthprime_record_gaps(NthPrime* context, unsigned long long a,
+                                       unsigned long long b, NthPrimeGapCallback callback,
+                                       void* data);
+
+/* Meldet aufsteigend alle p, fr die alle Zahlen p + d eines der Muster
+   (Bit d gesetzt, d < 64, Bit 0 muss gesetzt sein) Primzahlen in [a, b]
+   sind; passen mehrere Muster, in deren Reihenfolge. Es zhlen hchstens
+   NTHPRIME_MAX_PATTERNS Muster. */
+NTHPRIME_API void nthprime_tuples(NthPrime* context, unsigned long long a, unsigned long long b,
+                                  const unsigned long long* patterns, unsigned int count,
+                                  NthPrimeTupleCallback callback, void* data);
+
+/* Berechnet das Teilergebnis fr [a, b] (index bleibt 0). Ordnet shards
+   nach a und setzt index in allen; -1: die Bereiche grenzen nicht
+   lckenlos aneinander. */
+NTHPRIME_API void nthprime_shard(NthPrime* context, unsigned long long a, unsigned long long b,
+                                 NthPrimeShard* shard);
+NTHPRIME_API int nthprime_merge_shards(NthPrime* context, NthPrimeShard* shards,
+                                       unsigned long long count);
+
+/* Iterator ab start: next liefert zuerst die kleinste Primzahl >= start,
+   prev zuerst die grte < start, danach jeweils die nchste bzw. vorige
+   Primzahl zur zuletzt gelieferten (0: keine mehr); der Kontext muss bis
+   zum Freigeben des Iterators erhalten bleiben */
+NTHPRIME_API NthPrimeIterator* nthprime_iterator_create(NthPrime* context, unsigned long long start);
+NTHPRIME_API void nthprime_iterator_destroy(NthPrimeIterator* iterator);
+NTHPRIME_API unsigned long long nthprime_iterator_next(NthPrimeIterator* iterator);
+NTHPRIME_API unsigned long long nthprime_iterator_prev(NthPrimeIterator* iterator);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,6 +2,33 @@
 @rem --- verify that nth-prime is working correctly for at least some known
 @rem --- numbers of primes < 10^n, taken from: https://oeis.org/A006880
 @rem ----------------------------------------------------------------------
+@rem --- the engines that start at 3 every time only get the numbers up to 10^9
+@for %%e in (incremental) do @for %%n in (
+5
+26
+169
+1230
+9593
+78499
+664580
+5761456
+50847535
+) do @(
+  echo engine %%e
+  nth-prime --engine %%e %%n 2
+  echo ----------------------------------------
+)
+@rem --- small n, whose base primes are sieved with only a few primes
+@for %%n in (
+1000
+3000
+3614
+) do @(
+  nth-prime %%n
+  echo ----------------------------------------
+)
+@rem --- the primes around 10^k up to 10^17, found by jumping with pi(x);
+@rem --- 10^18 and 10^19 take about 5 and 20 minutes on one core
 @for %%n in (
 5
 26
@@ -20,8 +47,6 @@
 29844570422670
 279238341033926
 2623557157654234
-24739954287740861
-234057667276344608
 ) do @(
   nth-prime %%n 2
   echo ----------------------------------------
@@ -2,7 +2,7 @@
 # --- verify that nth-prime is working correctly for at least some known
 # --- numbers of primes < 10^n, taken from: https://oeis.org/A006880
 # ----------------------------------------------------------------------
-for n in \
+verify_numbers="\
 5 \
 26 \
 169 \
@@ -21,9 +21,61 @@ for n in \
 279238341033926 \
 2623557157654234 \
 24739954287740861 \
-234057667276344608 \
-; do
+234057667276344608"
+
+# ----------------------------------------------------------------------
+# --- every other engine of nth-prime (--engines) and nth-prime-alternative-1
+# --- have to show the same primes as the segmented sieve; they start at 3
+# --- every time, so they only get the numbers up to 10^9
+# ----------------------------------------------------------------------
+verify_limit=50847535
+
+for engine in $(./nth-prime --engines) nth-prime-alternative-1; do
+  [ "$engine" == "segmented" ] && continue
+  for n in $verify_numbers; do
+    [ $n -gt $verify_limit ] && break
+    if [ "$engine" == "nth-prime-alternative-1" ]; then
+      verify_output=$(./nth-prime-alternative-1 $n 2) || return
+    else
+      verify_output=$(./nth-prime --engine $engine $n 2) || return
+    fi
+    if [ "$verify_output" != "$(./nth-prime --engine segmented $n 2)" ]; then
+      echo "$engine: wrong primes for $n" >&2
+      return 1
+    fi
+  done
+  echo "$engine: ok"
+done
+echo ----------------------------------------
+
+# ----------------------------------------------------------------------
+# --- small n: each nth prime alone has to match line n of the list of
+# --- the first verify_small primes (the base primes of these are sieved
+# --- with only a handful of primes below their square root)
+# ----------------------------------------------------------------------
+verify_small=4000
+
+verify_list=$(./nth-prime -f bare 1 $verify_small) || return
+verify_n=0
+while read -r verify_prime; do
+  verify_n=$((verify_n + 1))
+  if [ "$(./nth-prime -f bare $verify_n)" != "$verify_prime" ]; then
+    echo "wrong prime for $verify_n" >&2
+    return 1
+  fi
+done <<< "$verify_list"
+echo "small n: ok"
+echo ----------------------------------------
+
+# ----------------------------------------------------------------------
+# --- the primes around 10^k, found by jumping with pi(x); pi(x) takes
+# --- about a minute at 10^17 on one core and grows by about 4 per power
+# --- of ten, so the larger numbers are only checked with VERIFY_MAX
+# ----------------------------------------------------------------------
+verify_max=${VERIFY_MAX:-2623557157654234}
+
+for n in $verify_numbers; do
+  [ $n -gt $verify_max ] && break
   ./nth-prime $n 2 || return
   echo ----------------------------------------
 done
-